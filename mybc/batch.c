@@ -0,0 +1,226 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+#include "parser.h"
+#include "vm.h"
+#include "batch.h"
+
+#define BLOCKROWS 256 // Número de linhas avaliadas por vez em cada vetor
+#define MAXCOLUMNS 256 // Número máximo de colunas de entrada
+
+// Colunas de entrada lidas do arquivo CSV
+static char *colname[MAXCOLUMNS];
+static double *coldata[MAXCOLUMNS];
+static int ncols = 0;
+static long nrows = 0;
+
+/*
+ * Kernels vetoriais: aplicam a operação a n elementos, usando AVX (4 doubles
+ * por instrução) ou SSE2 (2 doubles) quando disponíveis e completando o
+ * restante com código escalar.
+ */
+#if defined(__AVX__)
+#define VKERNEL(name, opr, vop)                                                   \
+    static void name(double *out, const double *a, const double *b, int n) {     \
+        int i = 0;                                                                \
+        for (; i + 4 <= n; i += 4)                                                \
+            _mm256_storeu_pd(out + i, vop(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i))); \
+        for (; i < n; i++) out[i] = a[i] opr b[i];                                \
+    }
+VKERNEL(vadd, +, _mm256_add_pd)
+VKERNEL(vsub, -, _mm256_sub_pd)
+VKERNEL(vmul, *, _mm256_mul_pd)
+VKERNEL(vdiv, /, _mm256_div_pd)
+#elif defined(__SSE2__)
+#define VKERNEL(name, opr, vop)                                                   \
+    static void name(double *out, const double *a, const double *b, int n) {     \
+        int i = 0;                                                                \
+        for (; i + 2 <= n; i += 2)                                                \
+            _mm_storeu_pd(out + i, vop(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i))); \
+        for (; i < n; i++) out[i] = a[i] opr b[i];                                \
+    }
+VKERNEL(vadd, +, _mm_add_pd)
+VKERNEL(vsub, -, _mm_sub_pd)
+VKERNEL(vmul, *, _mm_mul_pd)
+VKERNEL(vdiv, /, _mm_div_pd)
+#else
+#define VKERNEL(name, opr)                                                        \
+    static void name(double *out, const double *a, const double *b, int n) {     \
+        for (int i = 0; i < n; i++) out[i] = a[i] opr b[i];                       \
+    }
+VKERNEL(vadd, +)
+VKERNEL(vsub, -)
+VKERNEL(vmul, *)
+VKERNEL(vdiv, /)
+#endif
+
+/**
+ * Inverte o sinal de n elementos (troca o bit de sinal, como OP_NEG).
+ */
+static void vneg(double *out, const double *a, int n) {
+    int i = 0;
+#if defined(__SSE2__)
+    __m128d sign = _mm_set1_pd(-0.0);
+    for (; i + 2 <= n; i += 2)
+        _mm_storeu_pd(out + i, _mm_xor_pd(_mm_loadu_pd(a + i), sign));
+#endif
+    for (; i < n; i++) out[i] = -a[i];
+}
+
+/**
+ * Lê um arquivo CSV cuja primeira linha contém os nomes das colunas e as
+ * demais contêm valores numéricos.
+ * @param csv O arquivo de entrada.
+ * @return 0 em caso de sucesso, -1 em caso de erro.
+ */
+static int readcolumns(FILE *csv) {
+    char *line = NULL;
+    size_t linecap = 0;
+    long cap = 0;
+
+    if (getline(&line, &linecap, csv) < 0) {
+        fprintf(stderr, "arquivo de colunas vazio\n");
+        return -1;
+    }
+
+    // Cabeçalho: nomes das colunas separados por vírgula
+    for (char *tok = strtok(line, ",\r\n"); tok; tok = strtok(NULL, ",\r\n")) {
+        while (isspace((unsigned char)*tok)) tok++;
+        char *end = tok + strlen(tok);
+        while (end > tok && isspace((unsigned char)end[-1])) *--end = 0;
+        if (ncols == MAXCOLUMNS) {
+            fprintf(stderr, "colunas demais no arquivo de entrada\n");
+            return -1;
+        }
+        colname[ncols++] = strdup(tok);
+    }
+
+    // Linhas de dados
+    while (getline(&line, &linecap, csv) > 0) {
+        char *p = line;
+        if (*p == '\n' || *p == '\r') continue; // Ignora linhas vazias
+        if (nrows == cap) {
+            cap = cap ? 2 * cap : 4096;
+            for (int c = 0; c < ncols; c++) {
+                coldata[c] = realloc(coldata[c], cap * sizeof(double));
+                if (!coldata[c]) {
+                    fprintf(stderr, "memoria insuficiente para as colunas\n");
+                    return -1;
+                }
+            }
+        }
+        for (int c = 0; c < ncols; c++) {
+            coldata[c][nrows] = strtod(p, &p);
+            while (*p && *p != ',') p++;
+            if (*p == ',') p++;
+        }
+        nrows++;
+    }
+
+    free(line);
+    return 0;
+}
+
+/**
+ * Avalia o programa compilado sobre todas as linhas das colunas de entrada.
+ * As variáveis com o mesmo nome de uma coluna recebem, em cada linha, o valor
+ * da coluna; cada comando que imprime gera uma coluna de saída, e as colunas de
+ * saída são escritas em formato CSV, uma linha por linha de entrada.
+ * A avaliação é feita em blocos de BLOCKROWS linhas: cada posição da pilha é um
+ * vetor e cada instrução processa o bloco inteiro com os kernels vetoriais.
+ * @param csv O arquivo CSV de entrada.
+ * @return 0 em caso de sucesso, código de erro caso contrário.
+ */
+int batch(FILE *csv) {
+    if (readcolumns(csv) < 0) return EXIT_FAILURE;
+
+    // Associa cada coluna à posição da variável de mesmo nome
+    static double *column[MAXSYMTABSIZE];
+    for (int c = 0; c < ncols; c++) column[symindex(colname[c], strlen(colname[c]))] = coldata[c];
+
+    // Vetores de trabalho: um por posição da pilha, um por variável atribuída,
+    // um por constante e um por coluna de saída
+    int nout = 0;
+    for (int i = 0; i < codesize; i++)
+        if (code[i].op == OP_PRINT) nout++;
+
+    double (*scratch)[BLOCKROWS] = malloc((maxdepth + 1) * sizeof *scratch);
+    double (*consts)[BLOCKROWS] = malloc((codesize + 1) * sizeof *consts);
+    double (*outcols)[BLOCKROWS] = malloc((nout + 1) * sizeof *outcols);
+    static double varbuf[MAXSYMTABSIZE][BLOCKROWS];
+    static const double *var[MAXSYMTABSIZE];
+    const double **stack = malloc((maxdepth + 1) * sizeof *stack);
+    if (!scratch || !consts || !outcols || !stack) {
+        fprintf(stderr, "memoria insuficiente para a avaliacao em lote\n");
+        return EXIT_FAILURE;
+    }
+
+    // Constantes são expandidas para vetores uma única vez
+    for (int i = 0; i < codesize; i++)
+        if (code[i].op == OP_PUSHC)
+            for (int r = 0; r < BLOCKROWS; r++) consts[i][r] = code[i].value;
+
+    for (long row = 0; row < nrows; row += BLOCKROWS) {
+        int n = nrows - row < BLOCKROWS ? nrows - row : BLOCKROWS;
+        int sp = -1, out = 0;
+
+        // Cada bloco começa com as variáveis apontando para as colunas de entrada
+        // ou para vetores com o valor escalar da variável
+        for (int slot = 0; slot < MAXSYMTABSIZE; slot++) var[slot] = NULL;
+
+        for (int i = 0; i < codesize; i++) {
+            const INSTR *pc = &code[i];
+            switch (pc->op) {
+                case OP_PUSHC:
+                    stack[++sp] = consts[i];
+                    break;
+                case OP_LOAD:
+                    if (!var[pc->slot]) {
+                        if (column[pc->slot]) {
+                            var[pc->slot] = column[pc->slot] + row;
+                        } else {
+                            for (int r = 0; r < n; r++) varbuf[pc->slot][r] = vm[pc->slot];
+                            var[pc->slot] = varbuf[pc->slot];
+                        }
+                    }
+                    stack[++sp] = var[pc->slot];
+                    break;
+                case OP_STORE:
+                    // Valores ainda empilhados que apontam para o vetor da
+                    // variável são preservados antes de sobrescrevê-lo
+                    for (int k = 0; k < sp; k++)
+                        if (stack[k] == varbuf[pc->slot]) {
+                            memcpy(scratch[k], stack[k], n * sizeof(double));
+                            stack[k] = scratch[k];
+                        }
+                    if (stack[sp] != varbuf[pc->slot])
+                        memcpy(varbuf[pc->slot], stack[sp], n * sizeof(double));
+                    var[pc->slot] = varbuf[pc->slot];
+                    break;
+                case OP_ADD: sp--; vadd(scratch[sp], stack[sp], stack[sp + 1], n); stack[sp] = scratch[sp]; break;
+                case OP_SUB: sp--; vsub(scratch[sp], stack[sp], stack[sp + 1], n); stack[sp] = scratch[sp]; break;
+                case OP_MUL: sp--; vmul(scratch[sp], stack[sp], stack[sp + 1], n); stack[sp] = scratch[sp]; break;
+                case OP_DIV: sp--; vdiv(scratch[sp], stack[sp], stack[sp + 1], n); stack[sp] = scratch[sp]; break;
+                case OP_NEG: vneg(scratch[sp], stack[sp], n); stack[sp] = scratch[sp]; break;
+                case OP_PRINT:
+                    memcpy(outcols[out++], stack[sp--], n * sizeof(double));
+                    break;
+            }
+        }
+
+        // Escreve as colunas de saída do bloco, linha a linha
+        for (int r = 0; r < n; r++)
+            for (int c = 0; c < nout; c++)
+                printf("%lg%c", outcols[c][r], c + 1 < nout ? ',' : '\n');
+    }
+
+    free(scratch);
+    free(consts);
+    free(outcols);
+    free(stack);
+    return EXIT_SUCCESS;
+}
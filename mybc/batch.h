@@ -0,0 +1,8 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <stdio.h>
+
+extern int batch(FILE *csv);
+
+#endif
@@ -0,0 +1,242 @@
+/*
+ * Medição de desempenho do mybc: gera entradas sintéticas grandes e mede, para
+ * cada uma, a análise léxica isolada, a compilação completa e a compilação com
+ * execução, informando tokens/s, MB/s e pico de memória.
+ *
+ * Uso: benchmark gen <exprs|vars|numbers> <arquivo>
+ *      benchmark <arquivo>...
+ */
+#define _GNU_SOURCE // wait4
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include "main.h"
+#include "lexer.h"
+
+LEXER lexer; // Definido em main.c no interpretador
+
+// Fases medidas, cada uma num processo próprio para isolar o pico de memória
+enum {
+    PHASE_LEX,   // Apenas lexer_next até o fim do arquivo
+    PHASE_PARSE, // Compilação completa, sem executar
+    PHASE_RUN,   // Compilação e execução de cada comando
+};
+
+static const char *phase_names[] = {"lexer", "parser", "execucao"};
+
+// Resultado de uma fase, enviado do processo filho ao pai
+typedef struct {
+    double seconds;
+    long tokens;
+} RESULT;
+
+/**
+ * Relógio monotônico em segundos.
+ */
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/*
+ * Geradores de entradas sintéticas.
+ */
+
+/**
+ * Escreve uma expressão aleatória com a profundidade dada.
+ */
+static void gen_expr(FILE *out, int depth) {
+    if (depth == 0) {
+        if (rand() % 2) fprintf(out, "%d", 1 + rand() % 100);
+        else fprintf(out, "v%d", rand() % 16);
+        return;
+    }
+    fputc('(', out);
+    gen_expr(out, depth - 1);
+    fprintf(out, " %c ", "+-*/"[rand() % 4]);
+    gen_expr(out, depth - 1);
+    fputc(')', out);
+}
+
+/**
+ * Expressões aleatórias e expressões com parênteses aninhados muito fundo.
+ */
+static void gen_exprs(FILE *out) {
+    for (int v = 0; v < 16; v++) fprintf(out, "v%d := %d;\n", v, v + 1);
+    for (int s = 0; s < 20000; s++) {
+        fprintf(out, "v%d := ", s % 16);
+        gen_expr(out, 3 + rand() % 5);
+        fputs(";\n", out);
+    }
+    for (int s = 0; s < 50; s++) { // Aninhamento profundo
+        for (int d = 0; d < 2000; d++) fputc('(', out);
+        fputs("v0", out);
+        for (int d = 0; d < 2000; d++) fprintf(out, " + %d)", d % 7);
+        fputs(";\n", out);
+    }
+}
+
+/**
+ * Muitas variáveis distintas, atribuídas e lidas repetidamente.
+ */
+static void gen_vars(FILE *out) {
+    const int n = 1000; // Abaixo do limite da tabela de símbolos
+
+    for (int round = 0; round < 200; round++) {
+        for (int i = 0; i < n; i++) {
+            fprintf(out, "variable%d := variable%d + %d%s", i, (i + n - 1) % n, round, i % 8 == 7 ? ";\n" : "; ");
+        }
+        fputs("variable0;\n", out);
+    }
+}
+
+/**
+ * Constantes de todos os tipos: decimais, octais, hexadecimais e flutuantes.
+ */
+static void gen_numbers(FILE *out) {
+    for (int s = 0; s < 100000; s++) {
+        fprintf(out, "%d + 0%o - 0x%X + %d.%03d * %de-%d / .%d;\n",
+                rand(), rand() % 4096, rand(), rand() % 1000, rand() % 1000,
+                1 + rand() % 9, rand() % 20, 1 + rand() % 999);
+    }
+}
+
+/**
+ * Gera a entrada sintética do tipo pedido.
+ */
+static int generate(const char *kind, const char *path) {
+    static const struct {
+        const char *name;
+        void (*gen)(FILE *);
+    } generators[] = {
+        {"exprs", gen_exprs},
+        {"vars", gen_vars},
+        {"numbers", gen_numbers},
+    };
+
+    for (size_t i = 0; i < sizeof generators / sizeof generators[0]; i++) {
+        if (strcmp(kind, generators[i].name) == 0) {
+            FILE *out = fopen(path, "w");
+            if (!out) {
+                perror("Nao foi possivel criar a entrada");
+                return EXIT_FAILURE;
+            }
+            srand(1); // Entradas reprodutíveis
+            generators[i].gen(out);
+            fclose(out);
+            return EXIT_SUCCESS;
+        }
+    }
+    fprintf(stderr, "tipo de entrada desconhecido: %s\n", kind);
+    return EXIT_FAILURE;
+}
+
+/*
+ * Medição.
+ */
+
+/**
+ * Executa uma fase sobre o arquivo no processo corrente.
+ */
+static RESULT run_phase(int phase, const char *path) {
+    RESULT result = {0.0, 0};
+
+    FILE *src = fopen(path, "r");
+    if (!src) {
+        perror("Nao foi possivel abrir a entrada");
+        exit(EXIT_FAILURE);
+    }
+
+    double start = now();
+    lexer_file(&lexer, src);
+    if (phase == PHASE_LEX) {
+        while (lexer_next(&lexer) != EOF) result.tokens++;
+    } else {
+        immediate = phase == PHASE_RUN;
+        lookahead = lexer_next(&lexer);
+        mybc();
+    }
+    result.seconds = now() - start;
+
+    lexer_free(&lexer);
+    fclose(src);
+    return result;
+}
+
+/**
+ * Mede uma fase num processo filho, com a saída do programa descartada.
+ * @param rss Recebe o pico de memória do filho, em KiB.
+ */
+static RESULT measure(int phase, const char *path, long *rss) {
+    RESULT result = {0.0, -1};
+    int fd[2];
+
+    fflush(stdout);
+    if (pipe(fd) < 0) {
+        perror("pipe");
+        exit(EXIT_FAILURE);
+    }
+
+    pid_t pid = fork();
+    if (pid == 0) {
+        close(fd[0]);
+        if (!freopen("/dev/null", "w", stdout)) exit(EXIT_FAILURE);
+        RESULT r = run_phase(phase, path);
+        if (write(fd[1], &r, sizeof r) != sizeof r) exit(EXIT_FAILURE);
+        exit(EXIT_SUCCESS);
+    }
+
+    close(fd[1]);
+    if (read(fd[0], &result, sizeof result) != sizeof result) {
+        result.seconds = -1.0; // A fase falhou
+    }
+    close(fd[0]);
+
+    struct rusage usage;
+    int status;
+    wait4(pid, &status, 0, &usage);
+    *rss = usage.ru_maxrss;
+    return result;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc == 4 && strcmp(argv[1], "gen") == 0) {
+        return generate(argv[2], argv[3]);
+    }
+
+    if (argc < 2) {
+        fprintf(stderr, "Uso: %s gen <exprs|vars|numbers> <arquivo>\n"
+                        "     %s <arquivo>...\n", argv[0], argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    printf("%-24s %-9s %10s %12s %9s %10s\n", "arquivo", "fase", "tempo(s)", "tokens/s", "MB/s", "RSS(KiB)");
+    for (int i = 1; i < argc; i++) {
+        struct stat st;
+        if (stat(argv[i], &st) < 0) {
+            perror(argv[i]);
+            return EXIT_FAILURE;
+        }
+        double mb = st.st_size / 1e6;
+        long tokens = 0;
+
+        for (int phase = PHASE_LEX; phase <= PHASE_RUN; phase++) {
+            long rss;
+            RESULT r = measure(phase, argv[i], &rss);
+            if (r.seconds < 0) {
+                printf("%-24s %-9s %10s\n", argv[i], phase_names[phase], "falhou");
+                continue;
+            }
+            if (phase == PHASE_LEX) tokens = r.tokens; // As demais fases processam os mesmos tokens
+            printf("%-24s %-9s %10.4f %12.0f %9.1f %10ld\n", argv[i], phase_names[phase],
+                   r.seconds, tokens / r.seconds, mb / r.seconds, rss);
+        }
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,567 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include "bignum.h"
+
+#define BASE 1000000000u // Base dos limbs
+#define BASEDIGITS 9     // Dígitos decimais por limb
+#define KARATSUBA 32     // Limbs a partir dos quais a multiplicação usa Karatsuba
+#define LINELEN 70       // Comprimento das linhas de saída, como no bc
+#define MAXEXPONENT 1000000 // Maior expoente aceito numa constante
+
+static const uint32_t pow10[BASEDIGITS + 1] = {
+    1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000,
+};
+
+// Números temporários das operações; os resultados são calculados neles e
+// depois trocados com o destino, o que permite que o destino seja um operando
+static BIGNUM tmp_a, tmp_b, tmp_r;
+
+/**
+ * Aloca memória, encerrando o programa se não houver memória disponível.
+ */
+static void *xrealloc(void *p, size_t size) {
+    p = realloc(p, size ? size : 1);
+    if (!p) {
+        fprintf(stderr, "memoria insuficiente para o numero\n");
+        exit(EXIT_FAILURE);
+    }
+    return p;
+}
+
+/**
+ * Aloca n limbs zerados, encerrando o programa se não houver memória disponível.
+ */
+static uint32_t *xcalloc(size_t n) {
+    uint32_t *p = calloc(n ? n : 1, sizeof(uint32_t));
+    if (!p) {
+        fprintf(stderr, "memoria insuficiente para o numero\n");
+        exit(EXIT_FAILURE);
+    }
+    return p;
+}
+
+/**
+ * Garante espaço para n limbs em a.
+ */
+static void reserve(BIGNUM *a, int n) {
+    if (a->cap < n) {
+        a->cap = n < 2 * a->cap ? 2 * a->cap : n;
+        a->limb = xrealloc(a->limb, a->cap * sizeof(uint32_t));
+    }
+}
+
+/**
+ * Remove os limbs nulos mais significativos; o zero não tem sinal.
+ */
+static void trim(BIGNUM *a) {
+    while (a->len > 0 && a->limb[a->len - 1] == 0) a->len--;
+    if (a->len == 0) a->neg = 0;
+}
+
+/**
+ * Troca o conteúdo de dois números (apenas os ponteiros dos limbs).
+ */
+static void swap(BIGNUM *a, BIGNUM *b) {
+    BIGNUM t = *a;
+    *a = *b;
+    *b = t;
+}
+
+/**
+ * Calcula a = a * m + add para m e add menores que a base.
+ */
+static void mulsmall(BIGNUM *a, uint32_t m, uint32_t add) {
+    uint64_t carry = add;
+    for (int i = 0; i < a->len; i++) {
+        uint64_t t = (uint64_t)a->limb[i] * m + carry;
+        a->limb[i] = t % BASE;
+        carry = t / BASE;
+    }
+    if (carry) {
+        reserve(a, a->len + 1);
+        a->limb[a->len++] = carry;
+    }
+}
+
+/**
+ * Divide a magnitude de a por d (menor que a base), truncando.
+ * @return O resto da divisão.
+ */
+static uint32_t divsmall(BIGNUM *a, uint32_t d) {
+    uint64_t rem = 0;
+    for (int i = a->len - 1; i >= 0; i--) {
+        uint64_t t = rem * BASE + a->limb[i];
+        a->limb[i] = t / d;
+        rem = t % d;
+    }
+    trim(a);
+    return rem;
+}
+
+/**
+ * Multiplica a magnitude de a por 10^k: limbs inteiros são deslocados e o
+ * restante é uma multiplicação por um fator pequeno.
+ */
+static void mulpow10(BIGNUM *a, int k) {
+    if (a->len == 0 || k <= 0) return;
+    int shift = k / BASEDIGITS;
+    if (shift) {
+        reserve(a, a->len + shift);
+        memmove(a->limb + shift, a->limb, a->len * sizeof(uint32_t));
+        memset(a->limb, 0, shift * sizeof(uint32_t));
+        a->len += shift;
+    }
+    if (k % BASEDIGITS) mulsmall(a, pow10[k % BASEDIGITS], 0);
+}
+
+/**
+ * Divide a magnitude de a por 10^k, truncando.
+ */
+static void divpow10(BIGNUM *a, int k) {
+    if (k <= 0) return;
+    int shift = k / BASEDIGITS;
+    if (shift >= a->len) {
+        a->len = 0;
+        a->neg = 0;
+        return;
+    }
+    if (shift) {
+        memmove(a->limb, a->limb + shift, (a->len - shift) * sizeof(uint32_t));
+        a->len -= shift;
+    }
+    if (k % BASEDIGITS) divsmall(a, pow10[k % BASEDIGITS]);
+}
+
+/**
+ * Ajusta a escala de a, acrescentando zeros ou truncando dígitos.
+ */
+static void rescale(BIGNUM *a, int scale) {
+    if (scale > a->scale) mulpow10(a, scale - a->scale);
+    else divpow10(a, a->scale - scale);
+    a->scale = scale;
+}
+
+/*
+ * Operações sobre vetores de limbs (magnitudes sem sinal nem escala).
+ */
+
+/**
+ * Compara duas magnitudes sem limbs nulos no topo.
+ * @return Negativo, zero ou positivo, como strcmp.
+ */
+static int rawcmp(const uint32_t *a, int la, const uint32_t *b, int lb) {
+    if (la != lb) return la < lb ? -1 : 1;
+    for (int i = la - 1; i >= 0; i--)
+        if (a[i] != b[i]) return a[i] < b[i] ? -1 : 1;
+    return 0;
+}
+
+/**
+ * Calcula r = a + b; r deve ter espaço para max(la, lb) + 1 limbs.
+ * @return O número de limbs escritos em r.
+ */
+static int rawadd(uint32_t *r, const uint32_t *a, int la, const uint32_t *b, int lb) {
+    if (la < lb) {
+        const uint32_t *t = a; a = b; b = t;
+        int n = la; la = lb; lb = n;
+    }
+    uint32_t carry = 0;
+    int i = 0;
+    for (; i < lb; i++) {
+        uint32_t t = a[i] + b[i] + carry;
+        carry = t >= BASE;
+        r[i] = carry ? t - BASE : t;
+    }
+    for (; i < la; i++) {
+        uint32_t t = a[i] + carry;
+        carry = t >= BASE;
+        r[i] = carry ? t - BASE : t;
+    }
+    r[la] = carry;
+    return la + 1;
+}
+
+/**
+ * Calcula r = a - b, com a >= b; r pode coincidir com a.
+ */
+static void rawsub(uint32_t *r, const uint32_t *a, int la, const uint32_t *b, int lb) {
+    int64_t borrow = 0;
+    for (int i = 0; i < la; i++) {
+        int64_t t = (int64_t)a[i] - (i < lb ? b[i] : 0) - borrow;
+        borrow = t < 0;
+        r[i] = borrow ? t + BASE : t;
+    }
+}
+
+/**
+ * Soma a aos rl limbs de r, propagando o vai-um.
+ */
+static void rawaddto(uint32_t *r, int rl, const uint32_t *a, int la) {
+    uint32_t carry = 0;
+    for (int i = 0; i < rl && (i < la || carry); i++) {
+        uint32_t t = r[i] + (i < la ? a[i] : 0) + carry;
+        carry = t >= BASE;
+        r[i] = carry ? t - BASE : t;
+    }
+}
+
+/**
+ * Multiplica as magnitudes a e b; r deve estar zerado e ter la + lb limbs.
+ * Operandos pequenos usam o algoritmo escolar; a partir de KARATSUBA limbs,
+ * os operandos são divididos ao meio e o produto é montado com três
+ * multiplicações recursivas (Karatsuba) em vez de quatro.
+ */
+static void rawmul(uint32_t *r, const uint32_t *a, int la, const uint32_t *b, int lb) {
+    if (la < lb) {
+        const uint32_t *t = a; a = b; b = t;
+        int n = la; la = lb; lb = n;
+    }
+
+    if (lb < KARATSUBA) { // Algoritmo escolar
+        for (int i = 0; i < lb; i++) {
+            uint64_t carry = 0;
+            for (int j = 0; j < la; j++) {
+                uint64_t t = r[i + j] + (uint64_t)b[i] * a[j] + carry;
+                r[i + j] = t % BASE;
+                carry = t / BASE;
+            }
+            r[i + la] = carry;
+        }
+        return;
+    }
+
+    if (la >= 2 * lb) { // Operandos desbalanceados: multiplica a em fatias de lb limbs
+        uint32_t *t = xrealloc(NULL, 2 * lb * sizeof(uint32_t));
+        for (int off = 0; off < la; off += lb) {
+            int n = la - off < lb ? la - off : lb;
+            memset(t, 0, (n + lb) * sizeof(uint32_t));
+            rawmul(t, a + off, n, b, lb);
+            rawaddto(r + off, la + lb - off, t, n + lb);
+        }
+        free(t);
+        return;
+    }
+
+    // a = a1 * B^m + a0, b = b1 * B^m + b0
+    int m = lb / 2;
+    rawmul(r, a, m, b, m);                          // z0 = a0 * b0
+    rawmul(r + 2 * m, a + m, la - m, b + m, lb - m); // z2 = a1 * b1
+
+    // z1 = (a0 + a1)(b0 + b1) - z0 - z2
+    uint32_t *sa = xrealloc(NULL, (la - m + 1) * sizeof(uint32_t));
+    uint32_t *sb = xrealloc(NULL, (lb - m + 1) * sizeof(uint32_t));
+    int lsa = rawadd(sa, a, m, a + m, la - m);
+    int lsb = rawadd(sb, b, m, b + m, lb - m);
+    int lz = lsa + lsb;
+    uint32_t *z1 = xcalloc(lz);
+    rawmul(z1, sa, lsa, sb, lsb);
+    rawsub(z1, z1, lz, r, 2 * m);
+    rawsub(z1, z1, lz, r + 2 * m, la + lb - 2 * m);
+
+    rawaddto(r + m, la + lb - m, z1, lz); // r = z2 * B^2m + z1 * B^m + z0
+    free(sa);
+    free(sb);
+    free(z1);
+}
+
+/**
+ * Divide u por v (Knuth, algoritmo D), com vl >= 2 e ul >= vl, guardando em q
+ * os ul - vl + 1 limbs do quociente truncado.
+ */
+static void rawdiv(const uint32_t *u0, int ul, const uint32_t *v0, int vl, uint32_t *q) {
+    uint32_t *u = xrealloc(NULL, (ul + 1) * sizeof(uint32_t));
+    uint32_t *v = xrealloc(NULL, vl * sizeof(uint32_t));
+
+    // Normalização: multiplica ambos por f para que o limb mais significativo
+    // do divisor seja pelo menos BASE / 2, o que torna a estimativa precisa
+    uint32_t f = BASE / (v0[vl - 1] + 1);
+    uint64_t carry = 0;
+    for (int i = 0; i < ul; i++) {
+        uint64_t t = (uint64_t)u0[i] * f + carry;
+        u[i] = t % BASE;
+        carry = t / BASE;
+    }
+    u[ul] = carry;
+    carry = 0;
+    for (int i = 0; i < vl; i++) {
+        uint64_t t = (uint64_t)v0[i] * f + carry;
+        v[i] = t % BASE;
+        carry = t / BASE;
+    }
+
+    for (int j = ul - vl; j >= 0; j--) {
+        // Estima o dígito do quociente pelos dois limbs do topo
+        uint64_t num = (uint64_t)u[j + vl] * BASE + u[j + vl - 1];
+        uint64_t qhat = num / v[vl - 1];
+        uint64_t rhat = num % v[vl - 1];
+        while (qhat >= BASE || qhat * v[vl - 2] > rhat * BASE + u[j + vl - 2]) {
+            qhat--;
+            rhat += v[vl - 1];
+            if (rhat >= BASE) break;
+        }
+
+        // u[j..j+vl] -= qhat * v
+        int64_t borrow = 0;
+        carry = 0;
+        for (int i = 0; i < vl; i++) {
+            uint64_t p = qhat * v[i] + carry;
+            carry = p / BASE;
+            int64_t t = (int64_t)u[i + j] - (int64_t)(p % BASE) - borrow;
+            borrow = t < 0;
+            u[i + j] = borrow ? t + BASE : t;
+        }
+        int64_t top = (int64_t)u[j + vl] - (int64_t)carry - borrow;
+
+        if (top < 0) { // A estimativa excedeu em um: soma v de volta
+            qhat--;
+            uint32_t c = 0;
+            for (int i = 0; i < vl; i++) {
+                uint32_t t = u[i + j] + v[i] + c;
+                c = t >= BASE;
+                u[i + j] = c ? t - BASE : t;
+            }
+            top = 0;
+        }
+        u[j + vl] = top;
+        q[j] = qhat;
+    }
+
+    free(u);
+    free(v);
+}
+
+/*
+ * Operações sobre números.
+ */
+
+/**
+ * Copia a para r.
+ */
+void bn_copy(BIGNUM *r, const BIGNUM *a) {
+    if (r == a) return;
+    reserve(r, a->len);
+    if (a->len) memcpy(r->limb, a->limb, a->len * sizeof(uint32_t));
+    r->len = a->len;
+    r->neg = a->neg;
+    r->scale = a->scale;
+}
+
+/**
+ * Converte o texto de uma constante numérica para um número.
+ * @param text O texto da constante (sem sinal).
+ * @param len O comprimento do texto.
+ * @param radix A base: 8, 16 (com o prefixo 0x) ou 10 (com ponto e expoente opcionais).
+ */
+void bn_parse(BIGNUM *r, const char *text, int len, int radix) {
+    r->len = r->neg = r->scale = 0;
+
+    if (radix != 10) { // Octal ou hexadecimal: inteiros, dígito a dígito
+        for (int i = radix == 16 ? 2 : 0; i < len; i++) {
+            int c = text[i];
+            int d = c <= '9' ? c - '0' : (c | 0x20) - 'a' + 10;
+            mulsmall(r, radix, d);
+        }
+        return;
+    }
+
+    // Decimal: separa os dígitos, a posição do ponto e o expoente
+    char *digits = xrealloc(NULL, len + 1);
+    int nd = 0, frac = 0, infrac = 0, exp = 0, i;
+    for (i = 0; i < len && text[i] != 'e' && text[i] != 'E'; i++) {
+        if (text[i] == '.') {
+            infrac = 1;
+        } else {
+            digits[nd++] = text[i];
+            frac += infrac;
+        }
+    }
+    if (i < len) { // Expoente
+        int expneg = text[++i] == '-';
+        if (text[i] == '-' || text[i] == '+') i++;
+        for (; i < len; i++)
+            if (exp < MAXEXPONENT) exp = exp * 10 + text[i] - '0';
+        if (expneg) exp = -exp;
+    }
+
+    // Agrupa os dígitos em limbs, do menos significativo para o mais
+    reserve(r, nd / BASEDIGITS + 1);
+    for (int end = nd; end > 0; end -= BASEDIGITS) {
+        int start = end > BASEDIGITS ? end - BASEDIGITS : 0;
+        uint32_t limb = 0;
+        for (int k = start; k < end; k++) limb = limb * 10 + digits[k] - '0';
+        r->limb[r->len++] = limb;
+    }
+    free(digits);
+
+    trim(r);
+    r->scale = frac - exp;
+    if (r->scale < 0) { // Expoente maior que os dígitos fracionários
+        mulpow10(r, -r->scale);
+        r->scale = 0;
+    }
+}
+
+/**
+ * Soma a e (-1)^bneg * |b|, com a escala do operando de maior escala.
+ */
+static void addsigned(BIGNUM *r, const BIGNUM *a, const BIGNUM *b, int bneg) {
+    int scale = a->scale > b->scale ? a->scale : b->scale;
+    const BIGNUM *x = a, *y = b;
+
+    if (a->scale < scale) { // Alinha as vírgulas
+        bn_copy(&tmp_a, a);
+        rescale(&tmp_a, scale);
+        x = &tmp_a;
+    }
+    if (b->scale < scale) {
+        bn_copy(&tmp_b, b);
+        rescale(&tmp_b, scale);
+        y = &tmp_b;
+    }
+
+    reserve(&tmp_r, (x->len > y->len ? x->len : y->len) + 1);
+    if (x->neg == bneg) { // Mesmo sinal: soma as magnitudes
+        tmp_r.len = rawadd(tmp_r.limb, x->limb, x->len, y->limb, y->len);
+        tmp_r.neg = x->neg;
+    } else if (rawcmp(x->limb, x->len, y->limb, y->len) >= 0) { // Subtrai a menor da maior
+        rawsub(tmp_r.limb, x->limb, x->len, y->limb, y->len);
+        tmp_r.len = x->len;
+        tmp_r.neg = x->neg;
+    } else {
+        rawsub(tmp_r.limb, y->limb, y->len, x->limb, x->len);
+        tmp_r.len = y->len;
+        tmp_r.neg = bneg;
+    }
+    tmp_r.scale = scale;
+    trim(&tmp_r);
+    swap(r, &tmp_r);
+}
+
+/**
+ * Calcula r = a + b.
+ */
+void bn_add(BIGNUM *r, const BIGNUM *a, const BIGNUM *b) {
+    addsigned(r, a, b, b->neg);
+}
+
+/**
+ * Calcula r = a - b.
+ */
+void bn_sub(BIGNUM *r, const BIGNUM *a, const BIGNUM *b) {
+    addsigned(r, a, b, b->len ? !b->neg : 0);
+}
+
+/**
+ * Calcula r = a * b. Como no bc, o resultado mantém
+ * min(escala(a) + escala(b), max(scale, escala(a), escala(b))) dígitos decimais.
+ */
+void bn_mul(BIGNUM *r, const BIGNUM *a, const BIGNUM *b, int scale) {
+    int len = a->len + b->len;
+    reserve(&tmp_r, len);
+    memset(tmp_r.limb, 0, len * sizeof(uint32_t));
+    if (a->len && b->len) rawmul(tmp_r.limb, a->limb, a->len, b->limb, b->len);
+    tmp_r.len = len;
+    tmp_r.neg = a->neg ^ b->neg;
+    tmp_r.scale = a->scale + b->scale;
+    trim(&tmp_r);
+
+    int keep = a->scale > b->scale ? a->scale : b->scale;
+    if (scale > keep) keep = scale;
+    if (keep < tmp_r.scale) rescale(&tmp_r, keep);
+    swap(r, &tmp_r);
+}
+
+/**
+ * Calcula r = a / b com `scale` dígitos decimais, truncando como o bc.
+ * @return 0 em caso de sucesso, -1 se b for zero.
+ */
+int bn_div(BIGNUM *r, const BIGNUM *a, const BIGNUM *b, int scale) {
+    if (b->len == 0) return -1;
+
+    // a / b * 10^scale = (|a| * 10^k) / |b|, com k = scale + escala(b) - escala(a)
+    int k = scale + b->scale - a->scale;
+    int neg = a->neg ^ b->neg;
+    bn_copy(&tmp_a, a);
+    bn_copy(&tmp_b, b);
+    if (k >= 0) mulpow10(&tmp_a, k);
+    else mulpow10(&tmp_b, -k);
+
+    if (tmp_b.len == 1) { // Divisor de um limb: divisão curta
+        divsmall(&tmp_a, tmp_b.limb[0]);
+        swap(&tmp_r, &tmp_a);
+    } else if (rawcmp(tmp_a.limb, tmp_a.len, tmp_b.limb, tmp_b.len) < 0) {
+        tmp_r.len = 0;
+    } else {
+        reserve(&tmp_r, tmp_a.len - tmp_b.len + 1);
+        rawdiv(tmp_a.limb, tmp_a.len, tmp_b.limb, tmp_b.len, tmp_r.limb);
+        tmp_r.len = tmp_a.len - tmp_b.len + 1;
+    }
+    tmp_r.neg = neg;
+    tmp_r.scale = scale;
+    trim(&tmp_r);
+    swap(r, &tmp_r);
+    return 0;
+}
+
+/**
+ * Inverte o sinal de a.
+ */
+void bn_neg(BIGNUM *a) {
+    if (a->len) a->neg = !a->neg;
+}
+
+/**
+ * Converte a parte inteira de a para long, saturando nos limites.
+ */
+long bn_tolong(const BIGNUM *a) {
+    bn_copy(&tmp_a, a);
+    divpow10(&tmp_a, tmp_a.scale);
+    if (tmp_a.len > 2) return a->neg ? LONG_MIN : LONG_MAX;
+    long value = tmp_a.len == 0 ? 0 : tmp_a.limb[0];
+    if (tmp_a.len == 2) value += (long)tmp_a.limb[1] * BASE;
+    return a->neg ? -value : value;
+}
+
+/**
+ * Imprime a em decimal no formato do bc: sem o zero antes da vírgula, com
+ * `scale` dígitos fracionários e linhas longas quebradas com '\'.
+ */
+void bn_print(FILE *out, const BIGNUM *a) {
+    if (a->len == 0) {
+        fputs("0\n", out);
+        return;
+    }
+
+    // Dígitos da magnitude, do mais significativo para o menos
+    int size = a->len * BASEDIGITS + a->scale + 3;
+    char *digits = xrealloc(NULL, size);
+    int nd = sprintf(digits, "%u", a->limb[a->len - 1]);
+    for (int i = a->len - 2; i >= 0; i--) nd += sprintf(digits + nd, "%09u", a->limb[i]);
+
+    // Texto final: sinal, parte inteira, vírgula e parte fracionária
+    char *text = xrealloc(NULL, size + 1);
+    int n = 0;
+    if (a->neg) text[n++] = '-';
+    if (nd > a->scale) {
+        memcpy(text + n, digits, nd - a->scale);
+        n += nd - a->scale;
+    }
+    if (a->scale > 0) {
+        text[n++] = '.';
+        for (int z = nd; z < a->scale; z++) text[n++] = '0'; // Zeros após a vírgula
+        int fd = nd < a->scale ? nd : a->scale;
+        memcpy(text + n, digits + nd - fd, fd);
+        n += fd;
+    }
+
+    for (int i = 0; i < n; i += LINELEN - 1) { // Quebra as linhas longas
+        int chunk = n - i < LINELEN - 1 ? n - i : LINELEN - 1;
+        fwrite(text + i, 1, chunk, out);
+        fputs(i + chunk < n ? "\\\n" : "\n", out);
+    }
+
+    free(digits);
+    free(text);
+}
@@ -0,0 +1,29 @@
+#ifndef BIGNUM_H
+#define BIGNUM_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+// Número de precisão arbitrária: valor = (-1)^neg * mag / 10^scale, onde mag é
+// um inteiro guardado em limbs de base 10^9, o menos significativo primeiro.
+// Um BIGNUM zerado (como em variáveis estáticas) vale 0; os limbs alocados são
+// reaproveitados pelas operações seguintes.
+typedef struct {
+    int neg;        // 1 se negativo
+    int scale;      // Dígitos decimais após a vírgula
+    int len;        // Limbs em uso (0 para o valor zero)
+    int cap;        // Limbs alocados
+    uint32_t *limb; // Magnitude, base 10^9
+} BIGNUM;
+
+extern void bn_copy(BIGNUM *r, const BIGNUM *a);
+extern void bn_parse(BIGNUM *r, const char *text, int len, int radix);
+extern void bn_add(BIGNUM *r, const BIGNUM *a, const BIGNUM *b);
+extern void bn_sub(BIGNUM *r, const BIGNUM *a, const BIGNUM *b);
+extern void bn_mul(BIGNUM *r, const BIGNUM *a, const BIGNUM *b, int scale);
+extern int bn_div(BIGNUM *r, const BIGNUM *a, const BIGNUM *b, int scale);
+extern void bn_neg(BIGNUM *a);
+extern long bn_tolong(const BIGNUM *a);
+extern void bn_print(FILE *out, const BIGNUM *a);
+
+#endif
@@ -1,272 +1,421 @@
+#define _DEFAULT_SOURCE // getline e MAP_ANONYMOUS
 #include <stdio.h>
+#include <stdlib.h>
 #include <ctype.h>
 #include "lexer.h"
 #include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
-#define MAXLEN 32 // Define o tamanho máximo do lexema
-char lexeme[MAXLEN + 1]; // Array para armazenar o lexema atual
+/*
+ * Autômato finito determinístico para números. A tabela de transições foi
+ * derivada das definições regulares abaixo (o estado final reconhecido por
+ * último determina o token):
+ *   DEC = 0 | [1-9][0-9]*
+ *   OCT = 0[0-7]+
+ *   HEX = 0[xX][0-9a-fA-F]+
+ *   FLT = ([0-9]+ '.' [0-9]* | '.' [0-9]+ | [0-9]+) ([eE][+-]?[0-9]+)?
+ *         (com pelo menos o ponto ou o expoente)
+ */
+
+// Classes de caracteres (colunas da tabela)
+enum { C_OTHER, C_ZERO, C_OCT, C_DEC, C_HEX, C_E, C_X, C_DOT, C_SIGN, NCLASSES };
+
+// Estados (linhas da tabela); S_ERR é o estado morto
+enum {
+    S_ERR, S_START,
+    S_ZERO,    // "0"                          aceita DEC
+    S_OCT,     // "0[0-7]+"                    aceita OCT
+    S_ZDEC,    // "0" seguido de dígitos com 8 ou 9, só válido antes de '.' ou expoente
+    S_DEC,     // "[1-9][0-9]*"                aceita DEC
+    S_HEXX,    // "0x"
+    S_HEX,     // "0x[0-9a-f]+"                aceita HEX
+    S_DOT,     // "."
+    S_FRAC,    // parte fracionária            aceita FLT
+    S_EXP,     // "e"
+    S_EXPSIGN, // "e+" ou "e-"
+    S_EXPDIG,  // dígitos do expoente          aceita FLT
+    NSTATES
+};
+
+static const unsigned char transition[NSTATES][NCLASSES] = {
+    /*              OTHER  ZERO     OCT      DEC      HEX     E          X       DOT     SIGN */
+    [S_START]   = { S_ERR, S_ZERO,  S_DEC,   S_DEC,   S_ERR,  S_ERR,     S_ERR,  S_DOT,  S_ERR },
+    [S_ZERO]    = { S_ERR, S_OCT,   S_OCT,   S_ZDEC,  S_ERR,  S_EXP,     S_HEXX, S_FRAC, S_ERR },
+    [S_OCT]     = { S_ERR, S_OCT,   S_OCT,   S_ZDEC,  S_ERR,  S_EXP,     S_ERR,  S_FRAC, S_ERR },
+    [S_ZDEC]    = { S_ERR, S_ZDEC,  S_ZDEC,  S_ZDEC,  S_ERR,  S_EXP,     S_ERR,  S_FRAC, S_ERR },
+    [S_DEC]     = { S_ERR, S_DEC,   S_DEC,   S_DEC,   S_ERR,  S_EXP,     S_ERR,  S_FRAC, S_ERR },
+    [S_HEXX]    = { S_ERR, S_HEX,   S_HEX,   S_HEX,   S_HEX,  S_HEX,     S_ERR,  S_ERR,  S_ERR },
+    [S_HEX]     = { S_ERR, S_HEX,   S_HEX,   S_HEX,   S_HEX,  S_HEX,     S_ERR,  S_ERR,  S_ERR },
+    [S_DOT]     = { S_ERR, S_FRAC,  S_FRAC,  S_FRAC,  S_ERR,  S_ERR,     S_ERR,  S_ERR,  S_ERR },
+    [S_FRAC]    = { S_ERR, S_FRAC,  S_FRAC,  S_FRAC,  S_ERR,  S_EXP,     S_ERR,  S_ERR,  S_ERR },
+    [S_EXP]     = { S_ERR, S_EXPDIG,S_EXPDIG,S_EXPDIG,S_ERR,  S_ERR,     S_ERR,  S_ERR,  S_EXPSIGN },
+    [S_EXPSIGN] = { S_ERR, S_EXPDIG,S_EXPDIG,S_EXPDIG,S_ERR,  S_ERR,     S_ERR,  S_ERR,  S_ERR },
+    [S_EXPDIG]  = { S_ERR, S_EXPDIG,S_EXPDIG,S_EXPDIG,S_ERR,  S_ERR,     S_ERR,  S_ERR,  S_ERR },
+};
+
+// Token reconhecido em cada estado final (0 = estado não final)
+static const int accepting[NSTATES] = {
+    [S_ZERO] = DEC, [S_OCT] = OCT, [S_DEC] = DEC, [S_HEX] = HEX,
+    [S_FRAC] = FLT, [S_EXPDIG] = FLT,
+};
+
+// Classe de cada caractere
+static const unsigned char charclass[256] = {
+    ['0'] = C_ZERO,
+    ['1'] = C_OCT, ['2'] = C_OCT, ['3'] = C_OCT, ['4'] = C_OCT, ['5'] = C_OCT, ['6'] = C_OCT, ['7'] = C_OCT,
+    ['8'] = C_DEC, ['9'] = C_DEC,
+    ['a'] = C_HEX, ['b'] = C_HEX, ['c'] = C_HEX, ['d'] = C_HEX, ['e'] = C_E, ['f'] = C_HEX,
+    ['A'] = C_HEX, ['B'] = C_HEX, ['C'] = C_HEX, ['D'] = C_HEX, ['E'] = C_E, ['F'] = C_HEX,
+    ['x'] = C_X, ['X'] = C_X,
+    ['.'] = C_DOT,
+    ['+'] = C_SIGN, ['-'] = C_SIGN,
+};
+
+// Valor de cada dígito (até a base 16)
+static const unsigned char digitval[256] = {
+    ['0'] = 0, ['1'] = 1, ['2'] = 2, ['3'] = 3, ['4'] = 4,
+    ['5'] = 5, ['6'] = 6, ['7'] = 7, ['8'] = 8, ['9'] = 9,
+    ['a'] = 10, ['b'] = 11, ['c'] = 12, ['d'] = 13, ['e'] = 14, ['f'] = 15,
+    ['A'] = 10, ['B'] = 11, ['C'] = 12, ['D'] = 13, ['E'] = 14, ['F'] = 15,
+};
 
 /*
- * Função: isASGN
- * Descrição: Verifica se os próximos caracteres correspondem ao operador de atribuição ":="
- * Parâmetro: 
- *   - FILE *tape: Ponteiro para o arquivo de entrada.
- * Retorno: 
- *   - ASGN se o operador de atribuição for reconhecido, 0 caso contrário.
+ * Função: mapfile
+ * Descrição: Mapeia na memória, somente para leitura, o arquivo regular aberto
+ *   em tape. O mapeamento vai até a página seguinte ao fim do arquivo, que é
+ *   anônima e zerada, de modo que o texto sempre termina em '\0'.
+ * Parâmetros:
+ *   - FILE *tape: O arquivo de entrada.
+ *   - size_t *mapsize: Recebe o tamanho do mapeamento.
+ * Retorno:
+ *   - O início do texto, ou NULL para a entrada padrão, pipes, arquivos vazios
+ *     ou se o mapeamento falhar.
  */
-int isASGN(FILE *tape) {
-    if ((lexeme[0] = getc(tape)) == ':') {
-        if ((lexeme[1] = getc(tape)) == '=') {
-            lexeme[2] = 0; // Termina a string do lexema
-            return ASGN; // Retorna o token de atribuição
-        }
-        ungetc(lexeme[1], tape); // Coloca de volta o último caractere lido
+static char *mapfile(FILE *tape, size_t *mapsize) {
+    struct stat st;
+    int fd = fileno(tape);
+
+    if (fstat(fd, &st) < 0 || !S_ISREG(st.st_mode) || st.st_size == 0 || ftello(tape) != 0) return NULL;
+
+    size_t page = sysconf(_SC_PAGESIZE);
+    size_t length = ((size_t)st.st_size / page + 1) * page;
+    char *base = mmap(NULL, length, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED) return NULL;
+    if (mmap(base, st.st_size, PROT_READ, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED) {
+        munmap(base, length);
+        return NULL;
     }
-    ungetc(lexeme[0], tape); // Coloca de volta o caractere lido anteriormente
-    return 0; // Não reconhecido
+    madvise(base, st.st_size, MADV_SEQUENTIAL); // Lido uma vez, do início ao fim
+
+    *mapsize = length;
+    return base;
 }
 
 /*
- * Função: isID
- * Descrição: Verifica se os próximos caracteres correspondem a um identificador (ID).
- * Parâmetro: 
+ * Função: lexer_file
+ * Descrição: Prepara a análise de um arquivo. Arquivos regulares são mapeados
+ *   na memória e analisados no próprio lugar, sem cópia; a entrada padrão e
+ *   pipes são lidos linha a linha.
+ * Parâmetros:
+ *   - LEXER *lex: O analisador.
  *   - FILE *tape: Ponteiro para o arquivo de entrada.
- * Retorno: 
- *   - ID se um identificador for reconhecido, 0 caso contrário.
  */
-int isID(FILE *tape) {
-    lexeme[0] = getc(tape); // Lê o primeiro caractere
+void lexer_file(LEXER *lex, FILE *tape) {
+    size_t mapsize;
+    char *map = mapfile(tape, &mapsize);
+
+    if (map) {
+        lexer_string(lex, map);
+        lex->map = map;
+        lex->mapsize = mapsize;
+        return;
+    }
+    memset(lex, 0, sizeof *lex);
+    lex->file = tape;
+    lex->cur = lex->linestart = "";
+    lex->line = 1;
+}
 
-    if (isalpha(lexeme[0])) { // Verifica se é letra
-        int i = 1;
-        while (isalnum(lexeme[i] = getc(tape))) { // Lê caracteres alfanuméricos
-            i++;
-        }
+/*
+ * Função: lexer_string
+ * Descrição: Prepara a análise de um texto em memória, que deve permanecer
+ *   válido enquanto o analisador for usado.
+ * Parâmetros:
+ *   - LEXER *lex: O analisador.
+ *   - const char *text: O texto, terminado por '\0'.
+ */
+void lexer_string(LEXER *lex, const char *text) {
+    memset(lex, 0, sizeof *lex);
+    lex->cur = lex->linestart = text;
+    lex->line = 1;
+}
 
-        ungetc(lexeme[i], tape); // Coloca de volta o último caractere lido
-        lexeme[i] = 0; // Termina a string do lexema
+/*
+ * Função: lexer_free
+ * Descrição: Libera o buffer de linha ou o mapeamento do analisador. O arquivo
+ *   não é fechado.
+ */
+void lexer_free(LEXER *lex) {
+    free(lex->linebuf);
+    if (lex->map) munmap(lex->map, lex->mapsize);
+    lex->linebuf = lex->map = NULL;
+    lex->linecap = lex->mapsize = 0;
+    lex->cur = lex->linestart = "";
+}
 
-        return ID; // Retorna o token ID
+/*
+ * Função: nextline
+ * Descrição: Lê a próxima linha do arquivo para o buffer.
+ * Retorno:
+ *   - 1 se uma linha foi lida, 0 no fim da entrada.
+ */
+static int nextline(LEXER *lex) {
+    if (!lex->file || getline(&lex->linebuf, &lex->linecap, lex->file) < 0) {
+        lex->cur = lex->linestart = "";
+        return 0;
     }
+    lex->cur = lex->linestart = lex->linebuf;
+    return 1;
+}
 
-    ungetc(lexeme[0], tape); // Coloca de volta o caractere lido
-    lexeme[0] = 0; // Reseta o lexema
-
+/*
+ * Função: isASGN
+ * Descrição: Verifica se os próximos caracteres correspondem ao operador de atribuição ":="
+ * Retorno:
+ *   - ASGN se o operador de atribuição for reconhecido, 0 caso contrário.
+ */
+static int isASGN(LEXER *lex) {
+    if (lex->cur[0] == ':' && lex->cur[1] == '=') {
+        lex->cur += 2;
+        return ASGN; // Retorna o token de atribuição
+    }
     return 0; // Não reconhecido
 }
 
 /*
- * Função: isDEC
- * Descrição: Verifica se os próximos caracteres correspondem a um número decimal (DEC).
- * Parâmetro: 
- *   - FILE *tape: Ponteiro para o arquivo de entrada.
- * Retorno: 
- *   - DEC se um número decimal for reconhecido, 0 caso contrário.
+ * Função: isID
+ * Descrição: Verifica se os próximos caracteres correspondem a um identificador (ID).
+ * Retorno:
+ *   - ID se um identificador for reconhecido, 0 caso contrário.
  */
-int isDEC(FILE *tape) {
-    int i = 0;
-    lexeme[i] = getc(tape); // Lê o primeiro caractere
-
-    if (isdigit(lexeme[i])) { // Verifica se é um dígito
-        if (lexeme[i] == '0') { // Se for zero, é um número decimal
-            lexeme[i] = 0;
-            return DEC;
-        }
-        i++;
+static int isID(LEXER *lex) {
+    const char *cur = lex->cur;
 
-        while (isdigit(lexeme[i] = getc(tape))) { // Continua lendo enquanto for dígito
-            if (i < MAXLEN) i++;
+    if (isalpha((unsigned char)*cur)) { // Verifica se é letra
+        while (isalnum((unsigned char)*cur)) { // Lê caracteres alfanuméricos
+            cur++;
         }
+        lex->cur = cur;
 
-        ungetc(lexeme[i], tape); // Coloca de volta o último caractere lido
-        lexeme[i] = 0; // Termina a string do lexema
-        return DEC; // Retorna o token DEC
+        return ID; // Retorna o token ID
     }
 
-    ungetc(lexeme[i], tape); // Coloca de volta o caractere lido
-    lexeme[i] = 0; // Reseta o lexema
     return 0; // Não reconhecido
 }
 
-/*
- * Função: isOCTAL
- * Descrição: Verifica se os próximos caracteres correspondem a um número octal (OCT).
- * Parâmetro: 
- *   - FILE *tape: Ponteiro para o arquivo de entrada.
- * Retorno: 
- *   - OCT se um número octal for reconhecido, 0 caso contrário.
- */
-int isOCTAL(FILE *tape) {
-    int i = 0;
-    lexeme[i] = getc(tape); // Lê o primeiro caractere
-
-    if (lexeme[i] != '0') { // O primeiro caractere deve ser '0' para octal
-        ungetc(lexeme[i], tape); // Coloca de volta o caractere lido
-        lexeme[i] = 0;
-        return 0; // Não reconhecido
-    }
-
-    i++;
-    lexeme[i] = getc(tape); // Lê o próximo caractere
-    if (lexeme[i] < '0' || lexeme[i] > '7' || !isdigit(lexeme[i])) { // Verifica se está entre '0' e '7'
-        ungetc(lexeme[i], tape); // Coloca de volta o caractere lido
-        i--;
-        ungetc(lexeme[i], tape); // Coloca de volta o '0'
-        lexeme[i] = 0;
-        return 0; // Não reconhecido
-    }
+// Potências de 10 representáveis exatamente em double
+static const double pow10exact[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
 
-    i++;
+#define MAXEXACT (1ULL << 53) // Maior inteiro a partir do qual nem todos são exatos em double
 
-    // Continua lendo enquanto for um dígito octal
-    while ((lexeme[i] = getc(tape)) && (lexeme[i] >= '0') && (lexeme[i] <= '7')) {
-        if (i < MAXLEN) i++;
+/*
+ * Função: fltvalue
+ * Descrição: Converte um número flutuante já separado em mantissa inteira e
+ *   expoente decimal. Quando a mantissa e a potência de 10 são exatas em double
+ *   (caminho rápido de Clinger), uma única multiplicação ou divisão produz o
+ *   resultado corretamente arredondado; nos demais casos usa-se strtod.
+ * Parâmetros:
+ *   - unsigned long long mant: Os dígitos significativos, como inteiro.
+ *   - int exp10: O expoente decimal aplicado à mantissa.
+ *   - int exact: 0 se dígitos foram descartados da mantissa.
+ *   - const char *text: O texto do número, para o caminho lento.
+ * Retorno:
+ *   - O valor do número.
+ */
+static double fltvalue(unsigned long long mant, int exp10, int exact, const char *text) {
+    if (exact && mant <= MAXEXACT) {
+        if (exp10 == 0) return (double)mant;
+        if (exp10 < 0 && exp10 >= -22) return (double)mant / pow10exact[-exp10];
+        if (exp10 > 0 && exp10 <= 22) return (double)mant * pow10exact[exp10];
+        if (exp10 > 22 && exp10 <= 22 + 15) { // Parte do expoente cabe na mantissa
+            unsigned long long scaled = mant;
+            int e = exp10 - 22;
+            while (e > 0 && scaled <= MAXEXACT / 10) {
+                scaled *= 10;
+                e--;
+            }
+            if (e == 0) return (double)scaled * pow10exact[22];
+        }
     }
-    ungetc(lexeme[i], tape); // Coloca de volta o último caractere lido
-    lexeme[i] = 0; // Termina a string do lexema
-
-    return OCT; // Retorna o token OCT
+    return strtod(text, NULL); // Caminho lento, também corretamente arredondado
 }
 
 /*
- * Função: isHEX
- * Descrição: Verifica se os próximos caracteres correspondem a um número hexadecimal (HEX).
- * Parâmetro: 
- *   - FILE *tape: Ponteiro para o arquivo de entrada.
- * Retorno: 
- *   - HEX se um número hexadecimal for reconhecido, 0 caso contrário.
+ * Função: isNUM
+ * Descrição: Reconhece um número (decimal, octal, hexadecimal ou flutuante) numa
+ *   única passada pelo autômato, sem devolver caracteres à entrada: guarda-se a
+ *   posição do último estado final e a leitura recua até ela. O valor é
+ *   acumulado durante a varredura: inteiros são acumulados
+ *   exatamente na base do token, e flutuantes como mantissa inteira e expoente
+ *   decimal, convertidos por fltvalue.
+ * Parâmetro:
+ *   - LEXER *lex: O analisador; o valor fica em lex->val.
+ * Retorno:
+ *   - Um dos tokens: DEC, OCT, HEX, FLT ou 0 caso contrário.
  */
-int isHEX(FILE *tape) {
-    int i = 0;
-
-    lexeme[i] = getc(tape); // Lê o primeiro caractere
-    if (lexeme[i] != '0') { // O primeiro caractere deve ser '0'
-        ungetc(lexeme[i], tape); // Coloca de volta o caractere lido
-        return 0; // Não reconhecido
-    }
-    i++;
-
-    lexeme[i] = getc(tape); // Lê o próximo caractere
-    if (lexeme[i] != 'X' && lexeme[i] != 'x') { // Verifica se é 'X' ou 'x'
-        ungetc(lexeme[i], tape); // Coloca de volta o caractere lido
-        i--;
-        ungetc(lexeme[i], tape); // Coloca de volta o '0'
-        return 0; // Não reconhecido
+static int isNUM(LEXER *lex) {
+    const char *cur = lex->cur;
+    const char *p = cur;
+    const char *end = NULL; // Fim do maior prefixo reconhecido
+    int state = S_START, token = 0;
+    unsigned long long mant = 0;  // Dígitos decimais significativos
+    unsigned long long radix = 0; // Valor em base 8 ou 16
+    double wide = 0.0;            // Valor em base 8 ou 16 quando radix transborda
+    int scale = 0, expo = 0, expsign = 1; // Escala decimal e expoente
+    int exact = 1, overflow = 0;
+    // Acumuladores no último estado final (o estado S_ZDEC pode alterá-los
+    // antes de a leitura recuar)
+    unsigned long long acc_mant = 0, acc_radix = 0;
+    double acc_wide = 0.0;
+    int acc_scale = 0, acc_exact = 1, acc_overflow = 0;
+
+    for (;;) {
+        unsigned char c = *p;
+        int next = transition[state][charclass[c]];
+        if (next == S_ERR) break;
+        p++;
+
+        // Ações semânticas da transição: acumulam o valor
+        switch (next) {
+            case S_ZERO: case S_OCT: case S_ZDEC: case S_DEC:
+                if (radix >> 61) overflow = 1;
+                radix = radix * 8 + digitval[c];
+                wide = wide * 8 + digitval[c];
+                /* fallthrough */
+            case S_FRAC:
+                if (c == '.') break;
+                if (mant < 1000000000000000000ULL) { // Ainda cabe mais um dígito
+                    mant = mant * 10 + digitval[c];
+                    if (next == S_FRAC) scale--;
+                } else { // Dígito descartado: só afeta a escala
+                    if (digitval[c]) exact = 0;
+                    if (next != S_FRAC) scale++;
+                }
+                break;
+            case S_HEX:
+                if (radix >> 60) overflow = 1;
+                radix = radix * 16 + digitval[c];
+                wide = wide * 16 + digitval[c];
+                break;
+            case S_EXPSIGN:
+                if (c == '-') expsign = -1;
+                break;
+            case S_EXPDIG:
+                if (expo < 100000) expo = expo * 10 + digitval[c];
+                break;
+        }
+        state = next;
+
+        if (accepting[state]) { // Registra o último estado final
+            end = p;
+            token = accepting[state];
+            acc_mant = mant;
+            acc_radix = radix;
+            acc_wide = wide;
+            acc_scale = scale;
+            acc_exact = exact;
+            acc_overflow = overflow;
+        }
     }
-    i++;
 
-    // Continua lendo enquanto for um dígito hexadecimal
-    while (isxdigit(lexeme[i] = getc(tape))) {
-        if (i < MAXLEN) i++;
+    if (!token) return 0; // Nenhum prefixo é um número
+
+    switch (token) {
+        case OCT:
+        case HEX:
+            lex->val = acc_overflow ? acc_wide : (double)acc_radix;
+            break;
+        case DEC:
+            lex->val = acc_scale == 0 ? (double)acc_mant : strtod(cur, NULL);
+            break;
+        default: // FLT
+            lex->val = fltvalue(acc_mant, acc_scale + expsign * expo, acc_exact, cur);
     }
-    ungetc(lexeme[i], tape); // Coloca de volta o último caractere lido
-    lexeme[i] = 0; // Termina a string do lexema
 
-    return HEX; // Retorna o token HEX
+    lex->cur = end;
+    return token;
 }
 
 /*
- * Função: isFLOAT
- * Descrição: Verifica se os próximos caracteres correspondem a um número flutuante (FLT).
- * Parâmetro: 
- *   - FILE *tape: Ponteiro para o arquivo de entrada.
- * Retorno: 
- *   - FLT se um número flutuante for reconhecido, 0 caso contrário.
+ * Função: skipspaces
+ * Descrição: Ignora espaços em branco e conta linhas, lendo novas linhas do
+ *   arquivo conforme necessário. No modo de sessão a quebra de linha não é
+ *   ignorada, pois encerra o comando corrente.
  */
-int isFLOAT(FILE *tape) {
-    int i = 0;
-    lexeme[i] = getc(tape); // Lê o primeiro caractere
-
-    if (lexeme[i] == '.') { // Se o primeiro caractere for um ponto
-        i++;
-        if (isdigit(lexeme[i] = getc(tape))) { // Verifica se o próximo caractere é um dígito
-            i++;
-            while (isdigit(lexeme[i] = getc(tape))) { // Lê os dígitos após o ponto
-                i++;
+static void skipspaces(LEXER *lex) {
+    for (;;) {
+        const char *cur = lex->cur;
+        if (*cur == 0) { // Fim da linha corrente
+            if (!nextline(lex)) return;
+        } else if (isspace((unsigned char)*cur)) {
+            if (*cur == '\n') { // Conta novas linhas
+                lex->line++;
+                if (lex->session) return; // Devolvida ao parser como delimitador
+                lex->linestart = cur + 1;
             }
-
-            ungetc(lexeme[i], tape); // Coloca de volta o último caractere lido
-            lexeme[i] = 0; // Termina a string do lexema
-            return FLT; // Retorna o token FLT
+            lex->cur = cur + 1;
         } else {
-            ungetc(lexeme[i], tape); // Coloca de volta o caractere lido
-            ungetc(lexeme[i - 1], tape); // Coloca de volta o ponto
-            lexeme[i] = 0; // Reseta o lexema
-            return 0; // Não reconhecido
+            return;
         }
-    } else {
-        ungetc(lexeme[i], tape); // Coloca de volta o caractere lido
-        if (isDEC(tape) == DEC) { // Verifica se é um número decimal
-            i = strlen(lexeme); // Armazena o tamanho do lexema
-            lexeme[i] = getc(tape); // Lê o próximo caractere
-            if (lexeme[i] == '.') { // Se for um ponto, continua
-                i++;
-                while (isdigit(lexeme[i] = getc(tape))) { i++; }; // Lê os dígitos após o ponto
-                ungetc(lexeme[i], tape); // Coloca de volta o último caractere lido
-                lexeme[i] = 0; // Termina a string do lexema
-
-                return FLT; // Retorna o token FLT
-            } else {
-                ungetc(lexeme[i], tape); // Coloca de volta o caractere lido
-                return DEC; // Retorna o token DEC
-            }
-        }
-        return 0; // Não reconhecido
     }
 }
 
 /*
- * Função: isNUM
- * Descrição: Verifica se os próximos caracteres correspondem a um número (decimal, octal, hexadecimal ou flutuante).
- * Parâmetro: 
- *   - FILE *source: Ponteiro para o arquivo de entrada.
- * Retorno: 
- *   - Um dos tokens: OCT, HEX, FLT ou 0 caso contrário.
+ * Função: lexer_skipline
+ * Descrição: Descarta o restante da linha corrente, inclusive a quebra de linha.
  */
-int isNUM(FILE *source) {
-    int token;
-    if ((token = isOCTAL(source))) return token; // Verifica octal
-    if ((token = isHEX(source))) return token; // Verifica hexadecimal
-    if ((token = isFLOAT(source))) return token; // Verifica flutuante
-    return 0; // Não reconhecido
-}
+void lexer_skipline(LEXER *lex) {
+    const char *newline = strchr(lex->cur, '\n');
 
-int linenum = 1; // Contador de linhas para rastreamento de erros
-
-/*
- * Função: skipspaces
- * Descrição: Ignora espaços em branco e conta linhas.
- * Parâmetro: 
- *   - FILE *tape: Ponteiro para o arquivo de entrada.
- */
-void skipspaces(FILE *tape) {
-    int head;
-
-    // Continua lendo enquanto for um espaço em branco
-    while (isspace(head = getc(tape))) {
-        if (head == '\n') // Conta novas linhas
-            linenum++;
+    if (!newline) { // Última linha, sem quebra
+        lex->cur = lex->file ? "" : lex->cur + strlen(lex->cur);
+        return;
     }
-
-    ungetc(head, tape); // Coloca de volta o último caractere lido
+    lex->line++;
+    lex->cur = lex->linestart = newline + 1;
 }
 
 /*
- * Função: gettoken
- * Descrição: Obtém o próximo token do arquivo de entrada, ignorando espaços em branco.
- * Parâmetro: 
- *   - FILE *source: Ponteiro para o arquivo de entrada.
- * Retorno: 
+ * Função: lexer_next
+ * Descrição: Obtém o próximo token da entrada, ignorando espaços em branco.
+ * Parâmetro:
+ *   - LEXER *lex: O analisador.
+ * Retorno:
  *   - O próximo token reconhecido.
  */
-int gettoken(FILE *source) {
+int lexer_next(LEXER *lex) {
     int token;
-    skipspaces(source); // Ignora espaços em branco
 
-    // Verifica os diferentes tipos de tokens
-    if ((token = isNUM(source))) return token; // Verifica se é um número
-    if ((token = isID(source))) return token; // Verifica se é um identificador
-    if ((token = isASGN(source))) return token; // Verifica se é um operador de atribuição
+    skipspaces(lex); // Ignora espaços em branco
+    lex->text = lex->cur;
+    lex->column = lex->cur - lex->linestart + 1;
+    if (*lex->cur == 0) {
+        lex->len = 0;
+        return EOF;
+    }
 
-    return getc(source); // Retorna o próximo caractere se nada for reconhecido
+    // Verifica os diferentes tipos de tokens
+    if (!(((isdigit((unsigned char)*lex->cur) || *lex->cur == '.') && (token = isNUM(lex))) || // Número
+          (token = isID(lex)) ||    // Identificador
+          (token = isASGN(lex)))) { // Operador de atribuição
+        token = (unsigned char)*lex->cur++; // O próximo caractere se nada for reconhecido
+        if (token == '\n') lex->linestart = lex->cur; // Quebra de linha do modo de sessão
+    }
+    lex->len = lex->cur - lex->text;
+    return token;
 }
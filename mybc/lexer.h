@@ -1,6 +1,7 @@
-#include <stdio.h>
+#ifndef LEXER_H
+#define LEXER_H
 
-#define MAXLEN 32
+#include <stdio.h>
 
 enum {
     ID = 1024,
@@ -11,6 +12,33 @@ enum {
     ASGN, // ASGN = ":="
 };
 
-extern int gettoken(FILE *);
-extern int linenum;
-extern char lexeme[];
+// Estado de uma análise léxica. Cada LEXER é independente, de modo que várias
+// entradas podem ser analisadas ao mesmo tempo (inclusive em threads distintas).
+// A entrada é um arquivo regular mapeado na memória, a entrada padrão ou um
+// pipe, lidos uma linha por vez para que o modo interativo nunca espere por
+// texto além da linha atual, ou um texto em memória terminado por '\0',
+// analisado no próprio lugar. Os tokens não são copiados: text e
+// len apontam para o trecho da entrada, sem limite de comprimento.
+typedef struct {
+    FILE *file;             // Arquivo lido linha a linha (NULL para texto em memória ou mapeado)
+    char *map;              // Arquivo mapeado na memória (NULL se não houver)
+    size_t mapsize;         // Tamanho do mapeamento
+    char *linebuf;          // Linha corrente lida do arquivo
+    size_t linecap;         // Capacidade de linebuf
+    const char *cur;        // Posição de leitura
+    const char *linestart;  // Início da linha corrente
+    int line;               // Linha corrente, para mensagens de erro
+    int column;             // Coluna do início do último token
+    int session;            // A quebra de linha é devolvida como token
+    const char *text;       // Texto do último token, na própria entrada (válido até o próximo token)
+    int len;                // Comprimento desse texto
+    double val;             // Valor do último número reconhecido
+} LEXER;
+
+extern void lexer_file(LEXER *, FILE *);
+extern void lexer_string(LEXER *, const char *);
+extern void lexer_free(LEXER *);
+extern int lexer_next(LEXER *);
+extern void lexer_skipline(LEXER *);
+
+#endif
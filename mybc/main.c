@@ -1,8 +1,12 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "main.h"
+#include "parser.h"
+#include "vm.h"
+#include "batch.h"
 
-FILE *src; // Ponteiro para o arquivo de entrada
+LEXER lexer; // Analisador léxico da entrada
 
 /*
  * Função: main
@@ -10,23 +14,83 @@ FILE *src; // Ponteiro para o arquivo de entrada
  * Parâmetros:
  *   - int argc: Número de argumentos da linha de comando.
  *   - char *argv[]: Array de strings contendo os argumentos da linha de comando.
+ *     Uso: mybc [-i] [-p] [-n vezes] [-c colunas.csv] [arquivo]; com -n o
+ *     programa compilado é executado novamente até completar o número de vezes,
+ *     sem reanalisar a entrada; com -c o programa é avaliado em lote sobre as
+ *     linhas do CSV; com -i a entrada é avaliada linha a linha numa sessão
+ *     persistente; com -p os cálculos usam precisão arbitrária.
  * Retorno: 
  *   - int: Código de saída do programa (0 em caso de sucesso).
  */
 int main(int argc, char *argv[]) {
+    int repeat = 1; // Número de execuções do programa compilado
+    int argi = 1;   // Índice do próximo argumento
+
+    FILE *src = stdin;    // Arquivo de entrada
+    FILE *columns = NULL; // Arquivo CSV do modo em lote
+    int session = 0;      // Modo de sessão (-i)
+
+    while (argc > argi && argv[argi][0] == '-') {
+        if (strcmp(argv[argi], "-i") == 0) { // Verifica a opção de sessão
+            session = 1;
+            argi++;
+            continue;
+        }
+        if (strcmp(argv[argi], "-p") == 0) { // Verifica a opção de precisão arbitrária
+            precise = 1;
+            scaleslot = symindex("scale", 5);
+            argi++;
+            continue;
+        }
+        if (argc == argi + 1) break; // Opções restantes exigem um valor
+        if (strcmp(argv[argi], "-n") == 0) { // Verifica a opção de repetição
+            repeat = atoi(argv[argi + 1]);
+        } else if (strcmp(argv[argi], "-c") == 0) { // Verifica a opção de avaliação em lote
+            columns = fopen(argv[argi + 1], "r");
+            if (!columns) {
+                fprintf(stderr, "Nao foi possivel encontrar o arquivo de colunas\n");
+                return EXIT_FAILURE;
+            }
+            immediate = 0; // O programa só é executado sobre as colunas
+        } else {
+            break;
+        }
+        argi += 2;
+    }
+
+    if (precise && columns) { // O modo em lote calcula em double, coluna a coluna
+        fprintf(stderr, "A opcao -p nao pode ser usada com -c\n");
+        return EXIT_FAILURE;
+    }
+
     // Verifica se foi passado um argumento (nome do arquivo) na linha de comando
-    if (argc > 1) {
-        src = fopen(argv[1], "r"); // Tenta abrir o arquivo para leitura
+    if (argc > argi) {
+        src = fopen(argv[argi], "r"); // Tenta abrir o arquivo para leitura
         if (!src) { // Se não conseguiu abrir o arquivo
             fprintf(stderr, "Nao foi possivel encontrar o arquivo\n"); // Exibe mensagem de erro
             return EXIT_FAILURE; // Retorna código de erro
         }
-    } else {
-        src = stdin; // Se nenhum arquivo for passado, lê da entrada padrão (stdin)
+    } // Se nenhum arquivo for passado, lê da entrada padrão (stdin)
+
+    lexer_file(&lexer, src);
+    lexer.session = session;
+    lookahead = lexer_next(&lexer); // Obtém o primeiro token da entrada
+    if (session) { // Sessão persistente: avalia linha a linha até o fim da entrada
+        mybcsession();
+        return EXIT_SUCCESS;
+    }
+
+    mybc(); // Compila e executa os comandos da entrada
+
+    if (columns) { // Avalia o programa compilado sobre as colunas
+        int status = batch(columns);
+        fclose(columns);
+        return status;
+    }
+
+    for (int i = 1; i < repeat; i++) { // Reexecuta o programa já compilado
+        execute(0);
     }
-    
-    lookahead = gettoken(src); // Obtém o primeiro token da entrada
-    mybc(); // Chama a função de análise (ou processamento) principal
 
     return EXIT_SUCCESS; // Retorna 0 para indicar sucesso
 }
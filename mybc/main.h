@@ -1,6 +1,6 @@
 extern int lookahead;
-
-extern int gettoken(FILE *);
+extern int immediate;
 
 extern void mybc(void);
+extern void mybcsession(void);
 
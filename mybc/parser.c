@@ -1,128 +1,118 @@
 #include <stdio.h>         
 #include <stdlib.h>       
 #include <string.h>       
+#include <setjmp.h>
 #include "lexer.h"        
 #include "parser.h"       
+#include "vm.h"
 
 int lookahead;            // Variável para armazenar o próximo token a ser analisado
+int immediate = 1;        // Executa cada comando logo após compilá-lo
+static jmp_buf recovery;  // Ponto de retomada após erro de sintaxe no modo de sessão
 
-// Definições de constantes para tamanhos máximos
-#define MAXSTACKSIZE 1024
-#define MAXSYMTABSIZE 1024
+// Número de posições do índice hash de variáveis (potência de 2, o dobro da tabela)
+#define HASHSIZE (2 * MAXSYMTABSIZE)
 
 // Declaração de variáveis globais
-double Acc, stack[MAXSTACKSIZE];          // A pilha para armazenar valores
-int sp = -1;                               // Índice da pilha (stack pointer)
-char symtab[MAXSYMTABSIZE][MAXLEN + 1];  // Tabela de símbolos para variáveis
-double vm[MAXSYMTABSIZE];                  // Valores das variáveis
-int symtab_next = 0;                       // Índice para a próxima posição na tabela de símbolos
+char *symtab[MAXSYMTABSIZE];  // Nomes das variáveis (uma cópia de cada, sem limite de comprimento)
+int symlen[MAXSYMTABSIZE];    // Comprimento de cada nome
+int symtab_next = 0;          // Índice para a próxima posição na tabela de símbolos
+int symtab_hash[HASHSIZE];    // Índice hash: posição da variável + 1 (0 = vazio)
 
 /**
- * Adiciona um valor à pilha.
- * @param x O valor a ser empilhado.
+ * Calcula o hash (FNV-1a) do nome de uma variável.
+ * @param varname O nome da variável.
+ * @param len O comprimento do nome.
+ * @return O hash do nome.
  */
-void Push(double x) {
-    if (sp < MAXSTACKSIZE - 1) { // Verifica se há espaço na pilha
-        stack[++sp] = x;         // Adiciona o valor à pilha
+unsigned hashname(const char *varname, int len) {
+    unsigned h = 2166136261u;
+    for (int i = 0; i < len; i++) {
+        h ^= (unsigned char)varname[i];
+        h *= 16777619u;
     }
+    return h;
 }
 
 /**
- * Remove e retorna o valor do topo da pilha.
- * @return O valor do topo da pilha ou 0.0 se a pilha estiver vazia.
+ * Obtém a posição de uma variável na tabela de símbolos.
+ * Cada nome é internado uma única vez, durante a compilação; a partir daí o
+ * código acessa vm[] diretamente pela posição. O nome pode ser um trecho da
+ * entrada (não precisa terminar em '\0'): só é copiado na primeira ocorrência.
+ * Se a variável não for encontrada, ela é adicionada (com valor inicial 0.0).
+ * @param varname O nome da variável.
+ * @param len O comprimento do nome.
+ * @return A posição da variável em vm[].
  */
-double Pop(void) {
-    return (sp >= 0) ? stack[sp--] : 0.0;  // Retorna 0.0 se a pilha estiver vazia
-}
+int symindex(const char *varname, int len) {
+    unsigned h = hashname(varname, len) & (HASHSIZE - 1);
 
-/**
- * Recupera o valor de uma variável da tabela de símbolos.
- * Se a variável não for encontrada, ela é adicionada com o valor 0.0.
- * @param varname O nome da variável a ser recuperada.
- * @return O valor da variável.
- */
-double recall(char *varname) {
-    for (int i = 0; i < symtab_next; i++) { // Busca na tabela de símbolos
-        if (strcmp(symtab[i], varname) == 0) { // Se a variável é encontrada
-            return vm[i];                      // Retorna o valor correspondente
+    while (symtab_hash[h]) { // Sondagem linear até achar o nome ou uma posição vazia
+        int i = symtab_hash[h] - 1;
+        if (symlen[i] == len && memcmp(symtab[i], varname, len) == 0) { // Se a variável é encontrada
+            return i;                                                   // Retorna sua posição
         }
+        h = (h + 1) & (HASHSIZE - 1);
     }
-    strcpy(symtab[symtab_next], varname);     // Adiciona a variável à tabela
-    symtab_next++;
-    return 0.0;                               // Retorna 0.0 se não encontrada
-}
 
-/**
- * Armazena um valor na tabela de símbolos.
- * Se a variável já existir, atualiza seu valor.
- * @param varname O nome da variável a ser armazenada.
- * @param x O valor a ser armazenado.
- */
-void store(char *varname, double x) {
-    for (int i = 0; i < symtab_next; i++) { // Busca na tabela de símbolos
-        if (strcmp(symtab[i], varname) == 0) { // Se a variável é encontrada
-            vm[i] = x;                        // Atualiza o valor
-            return;
-        }
+    if (symtab_next == MAXSYMTABSIZE) { // Verifica se ainda há espaço na tabela
+        fprintf(stderr, "tabela de simbolos cheia\n");
+        exit(EXIT_FAILURE);
     }
-    strcpy(symtab[symtab_next], varname);     // Adiciona nova variável
-    vm[symtab_next++] = x;                     // Armazena seu valor
-}
 
-/**
- * Executa uma operação aritmética.
- * @param op O operador ( +, -, *, / )
- * @param op1 O primeiro operando.
- * @param op2 O segundo operando.
- * @return O resultado da operação.
- */
-double execop(int op, double op1, double op2) {
-    switch (op) {
-        case '+': return op1 + op2;  // Adição
-        case '-': return op1 - op2;  // Subtração
-        case '*': return op1 * op2;  // Multiplicação
-        case '/': return op1 / op2;  // Divisão
-        default: return 0.0;         // Retorna 0.0 para operação inválida
+    char *copy = malloc(len + 1); // Adiciona a variável à tabela
+    if (!copy) {
+        fprintf(stderr, "memoria insuficiente para o programa\n");
+        exit(EXIT_FAILURE);
     }
+    memcpy(copy, varname, len);
+    copy[len] = 0;
+    symtab[symtab_next] = copy;
+    symlen[symtab_next] = len;
+    symtab_hash[h] = symtab_next + 1;
+    return symtab_next++;
 }
 
 /*
  * Produção E da gramática:
  * E →  [-]T{+ T} | [+]T{+ T} | [-]T{- T} | [+]T{- T}
- * Analisa expressões e retorna seu valor.
+ * Compila expressões para o código da máquina virtual.
  */
-double E(void) {
+void E(void) {
     int signal = (lookahead == '-' || lookahead == '+') ? lookahead : 0; // Verifica sinal
     if (signal) match(signal);  // Se houver sinal, consome o token
 
-    double T_val = T();         // Obtém o valor da expressão T
-    if (signal == '-') T_val = -T_val; // Se sinal negativo, inverte o valor
+    T();                        // Compila a expressão T
+    if (signal == '-') emitop(OP_NEG); // Se sinal negativo, inverte o valor
 
-    double E_val = T_val;       // Inicializa E_val com o valor de T
     while (lookahead == '+' || lookahead == '-') { // Enquanto houver operadores
         int oplus = lookahead;   // Armazena o operador
         match(oplus);            // Consome o operador
-        T_val = T();            // Obtém o próximo valor T
-        E_val = execop(oplus, E_val, T_val); // Executa a operação
+        T();                    // Compila o próximo termo
+        emitop(oplus == '+' ? OP_ADD : OP_SUB); // Emite a operação
     }
-    return E_val;               // Retorna o valor final da expressão
 }
 
 /**
- * Analisa um comando. Se for um comando válido, avalia e imprime o resultado.
+ * Analisa um comando. Se for um comando válido, compila-o e, no modo
+ * imediato, executa-o imprimindo o resultado.
  */
 void cmd(void) {
     if (lookahead == ';' || lookahead == '\n' || lookahead == EOF) {
         // Não faz nada se for apenas um delimitador
     } else {
-        double E_val = E();       // Avalia a expressão
-        printf("%lg\n", E_val);   // Imprime o resultado
+        int start = codesize;     // Início do código do comando
+        E();                      // Compila a expressão
+        emit(OP_PRINT, 0, 0.0);   // Imprime o resultado
+        if (immediate) execute(start); // Executa o comando recém-compilado
     }
 }
 
 /**
  * Função principal do interpretador.
- * Executa comandos enquanto houver tokens válidos.
+ * Compila e executa comandos enquanto houver tokens válidos; o programa
+ * compilado permanece em code[] e pode ser executado novamente sem
+ * reanálise da entrada.
  */
 void mybc(void) {
     cmd(); // Avalia o primeiro comando
@@ -133,56 +123,86 @@ void mybc(void) {
     match(EOF); // Consome o final do arquivo
 }
 
+/**
+ * Modo de sessão: avalia a entrada linha a linha, imprimindo e descarregando
+ * o resultado de cada comando assim que a linha termina. As variáveis em vm[]
+ * persistem entre as linhas; um erro de sintaxe descarta apenas o restante da
+ * linha em que ocorreu, e a sessão continua na linha seguinte.
+ */
+void mybcsession(void) {
+    if (setjmp(recovery)) { // Retomada após erro de sintaxe
+        discard(0);
+        if (lookahead != '\n' && lookahead != EOF) { // Descarta o restante da linha
+            lexer_skipline(&lexer);
+            lookahead = '\n';
+        }
+        fflush(stdout);
+    }
+
+    while (lookahead != EOF) {
+        cmd();          // Compila e executa o comando
+        discard(0);     // O código já executado não é mais necessário
+        fflush(stdout); // Entrega o resultado imediatamente
+        if (lookahead == ';' || lookahead == '\n') {
+            match(lookahead); // Consome o delimitador
+        } else if (lookahead != EOF) {
+            match('\n'); // Erro: o comando deveria terminar aqui
+        }
+    }
+}
+
 /*
  * Produção T da gramática:
  * T → F{* F}| F{/ F}
- * Analisa termos e retorna seu valor.
+ * Compila termos para o código da máquina virtual.
  */
-double T(void) {
-    double T_val = F(); // Obtém o valor do primeiro fator
+void T(void) {
+    F(); // Compila o primeiro fator
     while (lookahead == '*' || lookahead == '/') { // Enquanto houver multiplicação ou divisão
         int otimes = lookahead; // Armazena o operador
         match(otimes);          // Consome o operador
-        double F_val = F();     // Obtém o próximo fator
-        T_val = execop(otimes, T_val, F_val); // Executa a operação
+        F();                    // Compila o próximo fator
+        emitop(otimes == '*' ? OP_MUL : OP_DIV); // Emite a operação
     }
-    return T_val; // Retorna o valor final do termo
 }
 
 /*
  * Produção F da gramática:
  * F → ID | DEC | ( E )
- * Analisa fatores e retorna seu valor.
+ * Compila fatores para o código da máquina virtual.
  */
-double F(void) {
-    double F_val = 0.0; // Inicializa o valor do fator
-    char name[MAXLEN + 1]; // Buffer para o nome da variável
-
+void F(void) {
     switch (lookahead) {
         case '(': // Se for um parêntese
             match('('); // Consome o parêntese
-            F_val = E(); // Avalia a expressão dentro do parêntese
+            E(); // Compila a expressão dentro do parêntese
             match(')'); // Consome o parêntese de fechamento
             break;
         case OCT:
         case HEX:
         case DEC:
         case FLT:
-            F_val = atof(lexeme); // Converte o número para double
+            if (precise) { // Constante de precisão arbitrária, convertida do texto completo
+                emit(OP_PUSHC, bnconstant(lexer.text, lexer.len, lookahead == OCT ? 8 : lookahead == HEX ? 16 : 10), lexer.val);
+            } else {
+                emit(OP_PUSHC, 0, lexer.val); // Valor convertido pelo analisador léxico
+            }
             match(lookahead); // Consome o token numérico
             break;
-        default: // Se for uma variável
-            strcpy(name, lexeme); // Armazena o nome da variável
+        default: { // Se for uma variável
+            // A posição é obtida antes de consumir o token, enquanto o nome
+            // ainda está no buffer do analisador léxico
+            int slot = lookahead == ID ? symindex(lexer.text, lexer.len) : 0;
             match(ID); // Consome o token de ID
             if (lookahead == ASGN) { // Se houver um operador de atribuição
                 match(ASGN); // Consome o operador
-                F_val = E(); // Avalia a expressão
-                store(name, F_val); // Armazena o resultado na tabela de símbolos
+                E(); // Compila a expressão
+                emit(OP_STORE, slot, 0.0); // Armazena o resultado na variável
             } else {
-                F_val = recall(name); // Recupera o valor da variável
+                emit(OP_LOAD, slot, 0.0); // Recupera o valor da variável
             }
+        }
     }
-    return F_val; // Retorna o valor final do fator
 }
 
 /**
@@ -192,7 +212,7 @@ double F(void) {
  */
 void match(int expected) {
     if (lookahead == expected) {
-        lookahead = gettoken(src); // Consome o token esperado
+        lookahead = lexer_next(&lexer); // Consome o token esperado
     } else {
         fprintf(stderr, "incompatibilidade de token! esperado "); // Mensagem de erro
         if (33 <= expected && expected <= 126) {
@@ -201,6 +221,7 @@ void match(int expected) {
             fprintf(stderr, "numero"); // Indica que era esperado um número
         }
         fprintf(stderr, "%c\n", lookahead); // Mostra o token recebido
+        if (lexer.session) longjmp(recovery, 1); // No modo de sessão, segue na próxima linha
         exit(-2); // Encerra o programa com erro
     }
 }
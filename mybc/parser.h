@@ -1,13 +1,13 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include "lexer.h"
 
-extern FILE *src;
+extern LEXER lexer;
 
 extern void match(int);
 
 extern int lookahead;
-extern int gettoken(FILE *);
-extern char lexeme[];
 
-extern double T(void);
-extern double F(void);
\ No newline at end of file
+extern void T(void);
+extern void F(void);
+extern int symindex(const char *, int);
@@ -0,0 +1,266 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "vm.h"
+#include "bignum.h"
+
+INSTR *code = NULL;             // Programa compilado
+int codesize = 0;               // Número de instruções emitidas
+static int codecap = 0;         // Capacidade atual do vetor de instruções
+static int depth = 0;           // Profundidade da pilha ao final do código emitido
+int maxdepth = 0;               // Maior profundidade da pilha atingida pelo código emitido
+
+double stack[MAXSTACKSIZE];     // A pilha para armazenar valores
+double vm[MAXSYMTABSIZE];       // Valores das variáveis
+
+// Modo de precisão arbitrária: as constantes ficam em bnconst (OP_PUSHC usa
+// `slot` como índice) e a execução usa bnexecute
+int precise = 0;                // Calcula com BIGNUM em vez de double
+int scaleslot = -1;             // Posição da variável `scale`, como no bc
+static int bnscale = 0;         // Dígitos fracionários das divisões
+static BIGNUM *bnconst = NULL;  // Constantes do programa compilado
+static int nbnconst = 0, bnconstcap = 0;
+static BIGNUM bnstack[MAXSTACKSIZE]; // Pilha do modo de precisão arbitrária
+static BIGNUM bnvm[MAXSYMTABSIZE];   // Valores das variáveis nesse modo
+
+/**
+ * Acrescenta uma instrução ao programa compilado.
+ * A profundidade da pilha é acompanhada durante a emissão, de modo que a
+ * execução não precisa verificar transbordamento a cada operação.
+ * @param op O código de operação.
+ * @param slot A posição da variável (OP_LOAD/OP_STORE).
+ * @param value A constante (OP_PUSHC).
+ * @return O índice da instrução emitida.
+ */
+int emit(int op, int slot, double value) {
+    if (codesize == codecap) { // Aumenta o vetor de instruções quando necessário
+        codecap = codecap ? 2 * codecap : 256;
+        code = realloc(code, codecap * sizeof(INSTR));
+        if (!code) {
+            fprintf(stderr, "memoria insuficiente para o programa\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    switch (op) { // Efeito da instrução sobre a pilha
+        case OP_PUSHC:
+        case OP_LOAD:
+            if (++depth > MAXSTACKSIZE) {
+                fprintf(stderr, "expressao profunda demais\n");
+                exit(EXIT_FAILURE);
+            }
+            if (depth > maxdepth) maxdepth = depth;
+            break;
+        case OP_ADD:
+        case OP_SUB:
+        case OP_MUL:
+        case OP_DIV:
+        case OP_PRINT:
+            depth--;
+            break;
+    }
+
+    code[codesize].op = op;
+    code[codesize].slot = slot;
+    code[codesize].value = value;
+    return codesize++;
+}
+
+/**
+ * Descarta as instruções a partir de start, por exemplo as de um comando com
+ * erro de sintaxe ou as de um comando já executado no modo de sessão.
+ * @param start O índice da primeira instrução descartada.
+ */
+void discard(int start) {
+    for (int i = start; i < codesize; i++) { // Libera as constantes do código descartado
+        if (precise && code[i].op == OP_PUSHC && code[i].slot < nbnconst) {
+            nbnconst = code[i].slot;
+        }
+    }
+    codesize = start;
+    depth = 0;
+}
+
+/**
+ * Acrescenta uma constante de precisão arbitrária ao programa.
+ * @param text O texto da constante.
+ * @param len O comprimento do texto.
+ * @param radix A base da constante (8, 10 ou 16).
+ * @return O índice da constante, usado como `slot` de OP_PUSHC.
+ */
+int bnconstant(const char *text, int len, int radix) {
+    if (nbnconst == bnconstcap) {
+        int cap = bnconstcap ? 2 * bnconstcap : 64;
+        BIGNUM *grown = realloc(bnconst, cap * sizeof(BIGNUM));
+        if (!grown) {
+            fprintf(stderr, "memoria insuficiente para o programa\n");
+            exit(EXIT_FAILURE);
+        }
+        memset(grown + bnconstcap, 0, (cap - bnconstcap) * sizeof(BIGNUM));
+        bnconst = grown;
+        bnconstcap = cap;
+    }
+    bn_parse(&bnconst[nbnconst], text, len, radix);
+    return nbnconst++;
+}
+
+/**
+ * Remove a última instrução emitida, que deve ser uma constante (OP_PUSHC).
+ */
+static void dropconst(void) {
+    codesize--;
+    depth--;
+}
+
+/**
+ * Verifica se x é uma potência de 2 cujo inverso também é representável
+ * exatamente, caso em que dividir por x equivale a multiplicar por 1/x.
+ * @param x O divisor.
+ * @return 1 se a troca for exata, 0 caso contrário.
+ */
+static int exactreciprocal(double x) {
+    int exp;
+    return isfinite(x) && frexp(x, &exp) == 0.5 && exp > -1020 && exp < 1020;
+}
+
+/**
+ * Emite uma operação (OP_ADD, OP_SUB, OP_MUL, OP_DIV ou OP_NEG) aplicando
+ * otimizações locais sobre as instruções anteriores:
+ *   - subexpressões formadas só por constantes são calculadas na compilação;
+ *   - identidades exatas em IEEE 754 são eliminadas: x - 0, x + (-0), (-0) + x,
+ *     x * 1, 1 * x, x / 1 e -(-x). As formas x + 0 e x * 0 não são exatas
+ *     (sinal do zero, infinitos e NaN) e são mantidas;
+ *   - a divisão por uma potência de 2 vira multiplicação pelo inverso.
+ * No modo de precisão arbitrária nada é reescrito, pois os cálculos acima são
+ * feitos em double.
+ * @param op O código de operação.
+ */
+void emitop(int op) {
+    INSTR *last = codesize > 0 ? &code[codesize - 1] : NULL;
+    INSTR *prev = codesize > 1 ? &code[codesize - 2] : NULL;
+
+    if (precise) {
+        emit(op, 0, 0.0);
+        return;
+    }
+
+    if (op == OP_NEG) {
+        if (last && last->op == OP_PUSHC) { // -(c)
+            last->value = -last->value;
+            return;
+        }
+        if (last && last->op == OP_NEG) {   // -(-x)
+            codesize--;
+            return;
+        }
+        emit(OP_NEG, 0, 0.0);
+        return;
+    }
+
+    if (last && last->op == OP_PUSHC) {
+        double c = last->value;
+
+        if (prev && prev->op == OP_PUSHC) { // Duas constantes: calcula agora
+            switch (op) {
+                case OP_ADD: prev->value = prev->value + c; break;
+                case OP_SUB: prev->value = prev->value - c; break;
+                case OP_MUL: prev->value = prev->value * c; break;
+                case OP_DIV: prev->value = prev->value / c; break;
+            }
+            dropconst();
+            return;
+        }
+
+        if ((op == OP_SUB && c == 0.0 && !signbit(c)) ||
+            (op == OP_ADD && c == 0.0 && signbit(c)) ||
+            ((op == OP_MUL || op == OP_DIV) && c == 1.0)) {
+            dropconst(); // Elemento neutro à direita
+            return;
+        }
+
+        if (op == OP_DIV && exactreciprocal(c)) { // Redução de força
+            last->value = 1.0 / c;
+            op = OP_MUL;
+        }
+    } else if (last && last->op == OP_LOAD && prev && prev->op == OP_PUSHC) {
+        double c = prev->value;
+
+        if ((op == OP_MUL && c == 1.0) || (op == OP_ADD && c == 0.0 && signbit(c))) {
+            *prev = *last; // Elemento neutro à esquerda
+            dropconst();
+            return;
+        }
+    }
+
+    emit(op, 0, 0.0);
+}
+
+/**
+ * Executa o programa compilado com aritmética de precisão arbitrária.
+ * Uma divisão por zero interrompe o comando corrente, como no bc.
+ * @param start O índice da primeira instrução a executar.
+ */
+static void bnexecute(int start) {
+    BIGNUM *sp = bnstack - 1;   // Topo da pilha (vazia)
+    const INSTR *pc = code + start;
+    const INSTR *end = code + codesize;
+
+    for (; pc < end; pc++) {
+        switch (pc->op) {
+            case OP_PUSHC: bn_copy(++sp, &bnconst[pc->slot]); break;
+            case OP_LOAD:  bn_copy(++sp, &bnvm[pc->slot]); break;
+            case OP_STORE:
+                bn_copy(&bnvm[pc->slot], sp);
+                if (pc->slot == scaleslot) { // Nova escala das divisões
+                    long scale = bn_tolong(sp);
+                    bnscale = scale < 0 ? 0 : scale > MAXSCALE ? MAXSCALE : scale;
+                }
+                break;
+            case OP_ADD:   sp--; bn_add(sp, sp, sp + 1); break;
+            case OP_SUB:   sp--; bn_sub(sp, sp, sp + 1); break;
+            case OP_MUL:   sp--; bn_mul(sp, sp, sp + 1, bnscale); break;
+            case OP_DIV:
+                sp--;
+                if (bn_div(sp, sp, sp + 1, bnscale) < 0) {
+                    fflush(stdout);
+                    fprintf(stderr, "divisao por zero\n");
+                    return;
+                }
+                break;
+            case OP_NEG:   bn_neg(sp); break;
+            case OP_PRINT: bn_print(stdout, sp--); break;
+            case OP_HALT:  return;
+        }
+    }
+}
+
+/**
+ * Executa o programa compilado a partir da instrução `start` até o fim do código emitido.
+ * @param start O índice da primeira instrução a executar.
+ */
+void execute(int start) {
+    if (precise) {
+        bnexecute(start);
+        return;
+    }
+
+    double *sp = stack - 1;     // Topo da pilha (vazia)
+    const INSTR *pc = code + start;
+    const INSTR *end = code + codesize;
+
+    for (; pc < end; pc++) {
+        switch (pc->op) {
+            case OP_PUSHC: *++sp = pc->value; break;
+            case OP_LOAD:  *++sp = vm[pc->slot]; break;
+            case OP_STORE: vm[pc->slot] = *sp; break;
+            case OP_ADD:   sp--; *sp = *sp + sp[1]; break;
+            case OP_SUB:   sp--; *sp = *sp - sp[1]; break;
+            case OP_MUL:   sp--; *sp = *sp * sp[1]; break;
+            case OP_DIV:   sp--; *sp = *sp / sp[1]; break;
+            case OP_NEG:   *sp = -*sp; break;
+            case OP_PRINT: printf("%lg\n", *sp--); break;
+            case OP_HALT:  return;
+        }
+    }
+}
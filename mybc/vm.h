@@ -0,0 +1,43 @@
+#ifndef VM_H
+#define VM_H
+
+// Definições de constantes para tamanhos máximos
+#define MAXSTACKSIZE 1024
+#define MAXSYMTABSIZE 1024
+#define MAXSCALE 100000 // Maior valor aceito para `scale`
+
+// Códigos de operação da máquina virtual
+enum {
+    OP_HALT,  // Encerra a execução
+    OP_PUSHC, // Empilha a constante `value`
+    OP_LOAD,  // Empilha o valor da variável `slot`
+    OP_STORE, // Copia o topo da pilha para a variável `slot` (sem desempilhar)
+    OP_ADD,   // Soma os dois valores do topo
+    OP_SUB,   // Subtrai os dois valores do topo
+    OP_MUL,   // Multiplica os dois valores do topo
+    OP_DIV,   // Divide os dois valores do topo
+    OP_NEG,   // Inverte o sinal do topo
+    OP_PRINT, // Desempilha e imprime o topo
+};
+
+// Instrução da máquina virtual: operação e operando (posição de variável ou constante)
+typedef struct {
+    int op;
+    int slot;
+    double value;
+} INSTR;
+
+extern INSTR *code;             // Programa compilado
+extern int codesize;            // Número de instruções emitidas
+extern double vm[];             // Valores das variáveis
+extern int maxdepth;            // Maior profundidade da pilha atingida pelo código emitido
+extern int precise;             // Modo de precisão arbitrária
+extern int scaleslot;           // Posição da variável `scale`
+
+extern int emit(int op, int slot, double value);
+extern void emitop(int op);
+extern void execute(int start);
+extern void discard(int start);
+extern int bnconstant(const char *text, int len, int radix);
+
+#endif
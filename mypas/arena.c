@@ -0,0 +1,60 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "arena.h"
+
+#define ARENA_BLOCKSIZE 65536 // Tamanho padrão de cada bloco da arena
+#define ARENA_ALIGN 8         // Alinhamento das alocações
+
+/**
+ * Reserva `size` bytes zerados na arena, alinhados a ARENA_ALIGN.
+ * Um novo bloco só é obtido do sistema quando o bloco corrente se esgota.
+ */
+void *arena_alloc(ARENA *arena, size_t size)
+{
+    size = (size + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+
+    ARENA_BLOCK *block = arena->head;
+    if (!block || block->used + size > block->size)
+    {
+        size_t capacity = size > ARENA_BLOCKSIZE ? size : ARENA_BLOCKSIZE;
+        block = malloc(sizeof(ARENA_BLOCK) + capacity);
+        if (!block)
+        {
+            fprintf(stderr, "Erro: memória insuficiente.\n");
+            exit(EXIT_FAILURE);
+        }
+        block->size = capacity;
+        block->used = 0;
+        block->next = arena->head;
+        arena->head = block;
+    }
+
+    void *p = block->data + block->used;
+    block->used += size;
+    return memset(p, 0, size);
+}
+
+/**
+ * Copia uma string para a arena.
+ */
+char *arena_strdup(ARENA *arena, const char *s)
+{
+    size_t len = strlen(s) + 1;
+    return memcpy(arena_alloc(arena, len), s, len);
+}
+
+/**
+ * Libera todos os blocos da arena de uma só vez.
+ */
+void arena_free(ARENA *arena)
+{
+    ARENA_BLOCK *block = arena->head;
+    while (block)
+    {
+        ARENA_BLOCK *next = block->next;
+        free(block);
+        block = next;
+    }
+    arena->head = NULL;
+}
@@ -0,0 +1,27 @@
+// arena.h
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+// Bloco de memória de uma arena; os blocos formam uma lista encadeada
+typedef struct _arena_block_
+{
+    struct _arena_block_ *next;
+    size_t size; // Capacidade do bloco em bytes
+    size_t used; // Bytes já entregues
+    char data[];
+} ARENA_BLOCK;
+
+// Arena de alocação por incremento de ponteiro: não há liberação individual,
+// toda a memória é devolvida de uma vez por arena_free
+typedef struct _arena_
+{
+    ARENA_BLOCK *head; // Bloco corrente (o mais recente)
+} ARENA;
+
+void *arena_alloc(ARENA *arena, size_t size);
+char *arena_strdup(ARENA *arena, const char *s);
+void arena_free(ARENA *arena);
+
+#endif
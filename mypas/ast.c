@@ -0,0 +1,15 @@
+#include "ast.h"
+
+// Arena de onde são alocados todos os nós da árvore e os nomes que eles guardam
+_Thread_local ARENA ast_arena;
+
+/**
+ * Cria um nó zerado do tipo `kind` na arena da árvore.
+ */
+NODE *newnode(int kind, int line)
+{
+    NODE *node = arena_alloc(&ast_arena, sizeof(NODE));
+    node->kind = kind;
+    node->line = line;
+    return node;
+}
@@ -0,0 +1,101 @@
+// ast.h
+#ifndef AST_H
+#define AST_H
+
+#include "arena.h"
+
+// Tipos de nó da árvore sintática abstrata
+enum
+{
+    NODE_PROGRAM = 1, // Programa: nome e bloco
+    NODE_BLOCK,       // Bloco: variáveis, subprogramas e corpo
+    NODE_VAR,         // Declaração de variável ou parâmetro
+    NODE_PROC,        // Declaração de procedimento ou função
+    NODE_COMPOUND,    // BEGIN ... END
+    NODE_ASSIGN,      // Atribuição
+    NODE_CALL,        // Chamada de procedimento ou função
+    NODE_IF,          // IF ... THEN ... [ELSE ...]
+    NODE_WHILE,       // WHILE ... DO ...
+    NODE_REPEAT,      // REPEAT ... UNTIL ...
+    NODE_BINOP,       // Operação binária
+    NODE_UNOP,        // Operação unária
+    NODE_NUM,         // Constante numérica
+    NODE_VARREF,      // Uso de variável
+    NODE_CONV,        // Conversão de inteiro para real, inserida pela verificação de tipos
+};
+
+// Procedimentos predefinidos (guardados em `op` de um NODE_PROC sem bloco)
+enum
+{
+    BUILTIN_WRITE = 1, // write(e1, e2, ...)
+    BUILTIN_WRITELN,   // writeln(e1, e2, ...)
+};
+
+typedef struct _node_ NODE;
+
+// Nó da árvore. Os campos comuns ficam no início e os específicos de cada
+// tipo de nó compartilham a mesma memória na união `u`.
+struct _node_
+{
+    short kind; // Tipo do nó (NODE_*)
+    short type; // Tipo declarado (declarações) ou tipo do valor (expressões, após typecheck)
+    int op;     // Operador (token) em NODE_BINOP/NODE_UNOP ou BUILTIN_* em NODE_PROC
+    int line;   // Linha do código fonte
+    NODE *next; // Próximo elemento em listas (comandos, declarações, argumentos)
+    union
+    {
+        long value; // NODE_NUM
+
+        // NODE_VAR e NODE_PROC
+        struct
+        {
+            const char *name;
+            int objtype;  // VARIABLE, PROCEDURE_OBJ ou FUNCTION_OBJ
+            int lexlevel; // Nível léxico da declaração
+            int parmflag; // 1 para parâmetro por referência (var)
+            int offset;   // Deslocamento no registro de ativação (NODE_VAR) ou endereço de entrada (NODE_PROC)
+            int nparams;  // Número de parâmetros (NODE_PROC)
+            NODE *params; // Parâmetros (NODE_PROC)
+            NODE *block;  // Bloco do subprograma (NODE_PROC); NULL se reaproveitado do cache
+            struct _procache_ *cache; // Situação no cache incremental (NODE_PROC, apenas com --cache)
+        } decl;
+
+        // NODE_VARREF, NODE_CALL e NODE_ASSIGN
+        struct
+        {
+            NODE *decl; // Declaração referenciada
+            NODE *args; // Argumentos (NODE_CALL) ou expressão atribuída (NODE_ASSIGN)
+        } ref;
+
+        // NODE_BINOP, NODE_UNOP e NODE_CONV (apenas `left`)
+        struct
+        {
+            NODE *left, *right;
+        } bin;
+
+        // NODE_IF, NODE_WHILE e NODE_REPEAT
+        struct
+        {
+            NODE *cond;
+            NODE *then; // Comando do THEN/DO ou lista de comandos do REPEAT
+            NODE *els;
+        } ctl;
+
+        // NODE_PROGRAM e NODE_BLOCK
+        struct
+        {
+            const char *name; // Nome do programa (NODE_PROGRAM)
+            NODE *vars;       // Declarações de variáveis
+            NODE *subprogs;   // Declarações de subprogramas
+            NODE *body;       // Corpo (NODE_COMPOUND) ou bloco (NODE_PROGRAM)
+        } blk;
+
+        NODE *list; // NODE_COMPOUND: lista de comandos
+    } u;
+};
+
+extern _Thread_local ARENA ast_arena;
+
+NODE *newnode(int kind, int line);
+
+#endif
@@ -0,0 +1,340 @@
+// bench.c
+// Medição de desempenho do compilador: gera entradas sintéticas grandes e mede,
+// para cada uma, a análise léxica isolada, a análise sintática completa e a
+// compilação seguida da execução, informando tokens/s, MB/s e pico de memória.
+//
+// Uso: benchmark gen <exprs|decls|comments|nested> <arquivo>
+//      benchmark <arquivo>...
+#define _GNU_SOURCE // wait4
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include "parser.h"
+#include "tokens.h"
+#include "check.h"
+#include "codegen.h"
+#include "interp.h"
+
+// Variáveis globais definidas em main.c no compilador
+_Thread_local int lookahead;
+_Thread_local LEXER lexer;
+
+// Fases medidas, cada uma num processo próprio para isolar o pico de memória
+enum
+{
+    PHASE_LEX,   // Apenas a conversão do arquivo em tokens
+    PHASE_PARSE, // Análise sintática e de tipos completa (árvore e tabela de símbolos)
+    PHASE_RUN,   // Análise, geração de código e execução
+};
+
+static const char *phase_names[] = {"lexer", "parser", "execucao"};
+
+// Resultado de uma fase, enviado do processo filho ao pai
+typedef struct
+{
+    double seconds;
+    long tokens;
+} RESULT;
+
+/**
+ * Relógio monotônico em segundos.
+ */
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/*
+ * Geradores de entradas sintéticas.
+ */
+
+/**
+ * Escreve uma expressão inteira aleatória com a profundidade dada.
+ */
+static void gen_expr(FILE *out, int depth)
+{
+    static const char *ops[] = {"+", "-", "*", "div", "mod"};
+
+    if (depth == 0)
+    {
+        if (rand() % 2)
+            fprintf(out, "%d", rand() % 100);
+        else
+            fputs(rand() % 2 ? "x" : "y", out);
+        return;
+    }
+
+    int op = rand() % 5;
+    fputc('(', out);
+    gen_expr(out, depth - 1);
+    fprintf(out, " %s ", ops[op]);
+    if (op >= 3) // Divisor constante e não nulo
+        fprintf(out, "%d", 1 + rand() % 9);
+    else
+        gen_expr(out, depth - 1);
+    fputc(')', out);
+}
+
+/**
+ * Expressões aleatórias e expressões com parênteses aninhados muito fundo.
+ */
+static void gen_exprs(FILE *out)
+{
+    fputs("program exprs (input, output);\nvar x, y, i: integer;\nbegin\n  x := 1; y := 2; i := 0;\n", out);
+    fputs("  while i < 20 do\n  begin\n", out);
+    for (int s = 0; s < 3000; s++)
+    {
+        fprintf(out, "    %s := ", s % 2 ? "x" : "y");
+        gen_expr(out, 6 + rand() % 4);
+        fputs(" mod 1000;\n", out);
+    }
+    for (int s = 0; s < 20; s++) // Aninhamento profundo
+    {
+        fputs("    x := ", out);
+        for (int d = 0; d < 1000; d++)
+            fputc('(', out);
+        fputs("x", out);
+        for (int d = 0; d < 1000; d++)
+            fprintf(out, " + %d)", d % 7);
+        fputs(" mod 1000;\n", out);
+    }
+    fputs("    i := i + 1\n  end;\n  writeln(x, y)\nend.\n", out);
+}
+
+/**
+ * Dezenas de milhares de declarações de variáveis, cada uma usada uma vez.
+ */
+static void gen_decls(FILE *out)
+{
+    const int n = 15000; // Abaixo do limite da tabela de símbolos
+
+    fputs("program decls (input, output);\nvar\n", out);
+    for (int i = 0; i < n; i += 20)
+    {
+        fputs("  ", out);
+        for (int j = i; j < i + 20; j++)
+            fprintf(out, "variable%d%s", j, j + 1 < i + 20 ? ", " : ": integer;\n");
+    }
+    fputs("begin\n  variable0 := 1;\n", out);
+    for (int i = 1; i < n; i++)
+        fprintf(out, "  variable%d := variable%d + %d;\n", i, i - 1, i % 10);
+    fprintf(out, "  writeln(variable%d)\nend.\n", n - 1);
+}
+
+/**
+ * Blocos longos de comentários nos dois estilos entre poucos comandos.
+ */
+static void gen_comments(FILE *out)
+{
+    fputs("program comments (input, output);\nvar x: integer;\nbegin\n  x := 0;\n", out);
+    for (int b = 0; b < 4000; b++)
+    {
+        fputs("  {\n", out);
+        for (int l = 0; l < 20; l++)
+            fputs("    Permission is hereby granted, free of charge, to any person obtaining a copy\n", out);
+        fputs("  }\n  (*\n", out);
+        for (int l = 0; l < 10; l++)
+            fputs("   * Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do eiusmod.\n", out);
+        fprintf(out, "   *)\n  x := x + %d;\n", b % 10);
+    }
+    fputs("  writeln(x)\nend.\n", out);
+}
+
+/**
+ * Muitos procedimentos aninhados, como em teste4.pas, cada nível acessando
+ * variáveis dos níveis externos.
+ */
+static void gen_nested(FILE *out)
+{
+    const int groups = 400, depth = 24;
+
+    fputs("program nested (input, output);\nvar total: integer;\n", out);
+    for (int g = 0; g < groups; g++)
+    {
+        for (int d = 0; d < depth; d++)
+            fprintf(out, "%*sprocedure p%dx%d(n: integer);\n%*svar a%d: integer;\n",
+                    2 * d, "", g, d, 2 * d + 1, "", d);
+        for (int d = depth - 1; d >= 0; d--)
+        {
+            fprintf(out, "%*sbegin\n%*sa%d := n + %d;\n", 2 * d, "", 2 * d + 2, "", d, d);
+            if (d + 1 < depth)
+                fprintf(out, "%*sp%dx%d(a%d)\n", 2 * d + 2, "", g, d + 1, d);
+            else
+                fprintf(out, "%*stotal := total + a0 + a%d\n", 2 * d + 2, "", d);
+            fprintf(out, "%*send;\n", 2 * d, "");
+        }
+    }
+    fputs("begin\n  total := 0;\n", out);
+    for (int g = 0; g < groups; g++)
+        fprintf(out, "  p%dx0(%d);\n", g, g);
+    fputs("  writeln(total)\nend.\n", out);
+}
+
+/**
+ * Gera a entrada sintética do tipo pedido.
+ */
+static int generate(const char *kind, const char *path)
+{
+    static const struct
+    {
+        const char *name;
+        void (*gen)(FILE *);
+    } generators[] = {
+        {"exprs", gen_exprs},
+        {"decls", gen_decls},
+        {"comments", gen_comments},
+        {"nested", gen_nested},
+    };
+
+    for (size_t i = 0; i < sizeof generators / sizeof generators[0]; i++)
+    {
+        if (strcmp(kind, generators[i].name) == 0)
+        {
+            FILE *out = fopen(path, "w");
+            if (!out)
+            {
+                perror("Erro ao criar a entrada");
+                return 1;
+            }
+            srand(1); // Entradas reprodutíveis
+            generators[i].gen(out);
+            fclose(out);
+            return 0;
+        }
+    }
+    fprintf(stderr, "Tipo de entrada desconhecido: %s\n", kind);
+    return 1;
+}
+
+/*
+ * Medição.
+ */
+
+/**
+ * Executa uma fase sobre o arquivo no processo corrente.
+ */
+static RESULT run_phase(int phase, const char *path)
+{
+    RESULT result = {0.0, 0};
+
+    FILE *src = fopen(path, "r");
+    if (!src)
+    {
+        perror("Erro ao abrir a entrada");
+        exit(EXIT_FAILURE);
+    }
+
+    double start = now();
+    lexer_file(&lexer, src, &identifiers);
+    if (phase == PHASE_LEX)
+    {
+        result.tokens = tokenize(&tokens, &lexer) - 1; // Sem o fim de arquivo
+    }
+    else
+    {
+        tokenize(&tokens, &lexer);
+        NODE *program = mypas();
+        typecheck(program);
+        if (phase == PHASE_RUN)
+        {
+            codegen(program);
+            interpret();
+        }
+    }
+    result.seconds = now() - start;
+
+    tokens_free(&tokens);
+    lexer_free(&lexer);
+    fclose(src);
+    return result;
+}
+
+/**
+ * Mede uma fase num processo filho, com a saída do programa descartada.
+ * @param rss Recebe o pico de memória do filho, em KiB.
+ */
+static RESULT measure(int phase, const char *path, long *rss)
+{
+    RESULT result = {0.0, -1};
+    int fd[2];
+
+    fflush(stdout);
+    if (pipe(fd) < 0)
+    {
+        perror("pipe");
+        exit(EXIT_FAILURE);
+    }
+
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        close(fd[0]);
+        if (!freopen("/dev/null", "w", stdout))
+            exit(EXIT_FAILURE);
+        RESULT r = run_phase(phase, path);
+        if (write(fd[1], &r, sizeof r) != sizeof r)
+            exit(EXIT_FAILURE);
+        exit(EXIT_SUCCESS);
+    }
+
+    close(fd[1]);
+    if (read(fd[0], &result, sizeof result) != sizeof result)
+        result.seconds = -1.0; // A fase falhou
+    close(fd[0]);
+
+    struct rusage usage;
+    int status;
+    wait4(pid, &status, 0, &usage);
+    *rss = usage.ru_maxrss;
+    return result;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc == 4 && strcmp(argv[1], "gen") == 0)
+        return generate(argv[2], argv[3]);
+
+    if (argc < 2)
+    {
+        fprintf(stderr, "Uso: %s gen <exprs|decls|comments|nested> <arquivo>\n"
+                        "     %s <arquivo>...\n",
+                argv[0], argv[0]);
+        return 1;
+    }
+
+    printf("%-24s %-9s %10s %12s %9s %10s\n", "arquivo", "fase", "tempo(s)", "tokens/s", "MB/s", "RSS(KiB)");
+    for (int i = 1; i < argc; i++)
+    {
+        struct stat st;
+        if (stat(argv[i], &st) < 0)
+        {
+            perror(argv[i]);
+            return 1;
+        }
+        double mb = st.st_size / 1e6;
+        long tokens = 0;
+
+        for (int phase = PHASE_LEX; phase <= PHASE_RUN; phase++)
+        {
+            long rss;
+            RESULT r = measure(phase, argv[i], &rss);
+            if (r.seconds < 0)
+            {
+                printf("%-24s %-9s %10s\n", argv[i], phase_names[phase], "falhou");
+                continue;
+            }
+            if (phase == PHASE_LEX)
+                tokens = r.tokens; // As demais fases processam os mesmos tokens
+            printf("%-24s %-9s %10.4f %12.0f %9.1f %10ld\n", argv[i], phase_names[phase],
+                   r.seconds, tokens / r.seconds, mb / r.seconds, rss);
+        }
+    }
+    return 0;
+}
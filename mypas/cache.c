@@ -0,0 +1,466 @@
+// cache.c
+// Cache incremental de subprogramas. Cada procedimento ou função é identificado
+// pelo hash do seu texto e do ambiente visível na sua declaração (os símbolos
+// da tabela, com as assinaturas dos subprogramas). Se a chave já está no cache,
+// o parser pula o corpo e a geração de código copia o código guardado, refazendo
+// os endereços; caso contrário o subprograma é analisado e o seu código é
+// guardado ao final de uma compilação bem-sucedida.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cache.h"
+#include "symtab.h"
+
+#define CACHE_MAGIC "MYPASC3" // Identifica o formato do arquivo (inclui o '\0')
+
+_Thread_local CACHE *cache = NULL;
+
+/**
+ * Acrescenta `size` bytes ao hash `h`: FNV-1a aplicado a palavras de 8 bytes,
+ * com os bits altos dobrados sobre os baixos a cada passo, já que o texto dos
+ * subprogramas inteiros passa por aqui a cada compilação.
+ */
+HASH hash_bytes(HASH h, const void *data, size_t size)
+{
+    const unsigned char *p = data;
+    unsigned long long word;
+
+    for (; size >= sizeof(word); p += sizeof(word), size -= sizeof(word))
+    {
+        memcpy(&word, p, sizeof(word));
+        h = (h ^ word) * 1099511628211ULL;
+        h ^= h >> 32;
+    }
+    for (; size > 0; p++, size--)
+        h = (h ^ *p) * 1099511628211ULL;
+    return h;
+}
+
+/**
+ * Acrescenta um inteiro ao hash `h`.
+ */
+HASH hash_int(HASH h, long value)
+{
+    return hash_bytes(h, &value, sizeof(value));
+}
+
+static void *xmalloc(size_t size)
+{
+    void *p = malloc(size ? size : 1);
+    if (!p)
+    {
+        fprintf(stderr, "Erro: memória insuficiente.\n");
+        exit(EXIT_FAILURE);
+    }
+    return p;
+}
+
+/**
+ * Cria uma entrada com espaço para as instruções, os filhos e as realocações
+ * num único bloco de memória.
+ */
+static CACHEENTRY *newentry(HASH key, int ninstr, int nchildren, int nrelocs)
+{
+    CACHEENTRY *e = xmalloc(sizeof(CACHEENTRY) + ninstr * sizeof(INSTR) +
+                            nchildren * sizeof(HASH) + nrelocs * sizeof(RELOC));
+    e->key = key;
+    e->used = 0;
+    e->ninstr = ninstr;
+    e->nchildren = nchildren;
+    e->nrelocs = nrelocs;
+    e->code = (INSTR *)(e + 1);
+    e->children = (HASH *)(e->code + ninstr);
+    e->relocs = (RELOC *)(e->children + nchildren);
+    e->next = NULL;
+    return e;
+}
+
+/**
+ * Insere uma entrada no índice, dobrando o número de buckets quando o fator
+ * de carga passa de 1.
+ */
+static void insert(CACHE *c, CACHEENTRY *e)
+{
+    if (c->count >= c->nbuckets)
+    {
+        int nbuckets = c->nbuckets ? 2 * c->nbuckets : 256;
+        CACHEENTRY **buckets = calloc(nbuckets, sizeof(*buckets));
+        if (!buckets)
+        {
+            fprintf(stderr, "Erro: memória insuficiente.\n");
+            exit(EXIT_FAILURE);
+        }
+        for (int b = 0; b < c->nbuckets; b++)
+        {
+            CACHEENTRY *next;
+            for (CACHEENTRY *old = c->buckets[b]; old; old = next)
+            {
+                next = old->next;
+                old->next = buckets[old->key & (nbuckets - 1)];
+                buckets[old->key & (nbuckets - 1)] = old;
+            }
+        }
+        free(c->buckets);
+        c->buckets = buckets;
+        c->nbuckets = nbuckets;
+    }
+
+    e->next = c->buckets[e->key & (c->nbuckets - 1)];
+    c->buckets[e->key & (c->nbuckets - 1)] = e;
+    c->count++;
+}
+
+/**
+ * Procura a entrada com a chave `key`. Retorna NULL se não houver.
+ */
+CACHEENTRY *cache_find(CACHE *c, HASH key)
+{
+    if (!c->nbuckets)
+        return NULL;
+    for (CACHEENTRY *e = c->buckets[key & (c->nbuckets - 1)]; e; e = e->next)
+        if (e->key == key)
+            return e;
+    return NULL;
+}
+
+/**
+ * Soma de verificação do conteúdo de uma entrada, gravada junto com ela.
+ */
+static HASH checksum(const CACHEENTRY *e)
+{
+    HASH h = hash_bytes(HASH_SEED, &e->key, sizeof(e->key));
+    h = hash_bytes(h, e->code, e->ninstr * sizeof(INSTR));
+    h = hash_bytes(h, e->children, e->nchildren * sizeof(HASH));
+    return hash_bytes(h, e->relocs, e->nrelocs * sizeof(RELOC));
+}
+
+/**
+ * Verifica uma entrada lida do arquivo, que pode estar desatualizado, editado
+ * ou corrompido. A soma de verificação pega as alterações que ainda formam
+ * código plausível; as demais condições garantem que o código copiado não
+ * saia do que a geração produziria: operações conhecidas, desvios e chamadas
+ * internas dentro do subprograma, e realocações em ordem crescente, sobre
+ * instruções OP_CAL e com índices possíveis na tabela de símbolos.
+ */
+static int valid(const CACHEENTRY *e, HASH check)
+{
+    if (checksum(e) != check)
+        return 0; // Conteúdo alterado depois de gravado
+
+    int k = 0;
+    for (int i = 0; i < e->ninstr; i++)
+    {
+        const INSTR *in = &e->code[i];
+        if (in->op < 0 || in->op > OP_HLT || in->level < 0)
+            return 0;
+        if (k < e->nrelocs && e->relocs[k].at == i)
+        {
+            int symbol = e->relocs[k++].symbol;
+            if (in->op != OP_CAL || symbol <= 0 || symbol >= MAXSYMTABSIZE)
+                return 0;
+        }
+        else if ((in->op == OP_JMP || in->op == OP_JPC || in->op == OP_CAL) &&
+                 (in->arg < 0 || in->arg >= e->ninstr))
+        {
+            return 0;
+        }
+    }
+    return k == e->nrelocs; // Realocações fora de ordem ou além do código sobram
+}
+
+/**
+ * Libera todas as entradas, deixando o cache vazio.
+ */
+static void clear(CACHE *c)
+{
+    for (int b = 0; b < c->nbuckets; b++)
+    {
+        CACHEENTRY *next;
+        for (CACHEENTRY *e = c->buckets[b]; e; e = next)
+        {
+            next = e->next;
+            free(e);
+        }
+    }
+    free(c->buckets);
+    c->buckets = NULL;
+    c->nbuckets = c->count = 0;
+}
+
+/**
+ * Carrega o cache de <arquivo-fonte>.cache. Um arquivo ausente, de outro
+ * formato, truncado ou com alguma entrada inválida resulta num cache vazio,
+ * e o arquivo é regravado na próxima compilação bem-sucedida.
+ */
+void cache_open(CACHE *c, const char *source)
+{
+    memset(c, 0, sizeof(*c));
+    c->path = xmalloc(strlen(source) + sizeof(".cache"));
+    sprintf(c->path, "%s.cache", source);
+
+    FILE *in = fopen(c->path, "rb");
+    if (!in)
+        return;
+
+    fseek(in, 0, SEEK_END);
+    long size = ftell(in); // Limita os tamanhos lidos antes de alocar
+    rewind(in);
+
+    char magic[sizeof(CACHE_MAGIC)];
+    int count;
+    if (fread(magic, sizeof(magic), 1, in) != 1 || memcmp(magic, CACHE_MAGIC, sizeof(magic)) != 0 ||
+        fread(&count, sizeof(count), 1, in) != 1)
+    {
+        c->changed = 1;
+        fclose(in);
+        return;
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+        HASH key, check;
+        int sizes[3]; // Instruções, filhos e realocações
+        if (fread(&key, sizeof(key), 1, in) != 1 || fread(&check, sizeof(check), 1, in) != 1 ||
+            fread(sizes, sizeof(sizes), 1, in) != 1 ||
+            sizes[0] < 0 || sizes[1] < 0 || sizes[2] < 0 || sizes[2] > sizes[0] ||
+            (long long)sizes[0] * sizeof(INSTR) + (long long)sizes[1] * sizeof(HASH) +
+            (long long)sizes[2] * sizeof(RELOC) > size - ftell(in))
+            break;
+
+        CACHEENTRY *e = newentry(key, sizes[0], sizes[1], sizes[2]);
+        if (fread(e->code, sizeof(INSTR), e->ninstr, in) != (size_t)e->ninstr ||
+            fread(e->children, sizeof(HASH), e->nchildren, in) != (size_t)e->nchildren ||
+            fread(e->relocs, sizeof(RELOC), e->nrelocs, in) != (size_t)e->nrelocs || !valid(e, check))
+        {
+            free(e);
+            break;
+        }
+        insert(c, e);
+    }
+    if (c->count != count)
+    {
+        clear(c); // Uma entrada ruim põe em dúvida o arquivo inteiro
+        c->changed = 1;
+    }
+    fclose(in);
+}
+
+/**
+ * Gera o código de um subprograma reaproveitado do cache: copia as instruções
+ * guardadas, somando o novo endereço de entrada aos desvios e às chamadas
+ * internas, e completa as chamadas externas com o endereço atual do chamado.
+ */
+void cache_emit(NODE *proc)
+{
+    PROCACHE *pc = proc->u.decl.cache;
+    CACHEENTRY *e = pc->entry;
+    int start = codesize;
+    int k = 0;
+
+    proc->u.decl.offset = start;
+    emit_block(e->code, e->ninstr);
+    for (int i = 0; i < e->ninstr; i++)
+    {
+        INSTR *in = &code[start + i];
+        if (k < e->nrelocs && e->relocs[k].at == i)
+            in->arg = pc->callees[k++]->u.decl.offset;
+        else if (in->op == OP_JMP || in->op == OP_JPC || in->op == OP_CAL)
+            in->arg += start;
+    }
+}
+
+/**
+ * Marca uma entrada, e os subprogramas aninhados nela, para serem mantidos.
+ * Um subprograma reaproveitado não é analisado, mas os aninhados continuam
+ * úteis se ele for editado mais tarde.
+ */
+static void keep(CACHE *c, CACHEENTRY *e)
+{
+    if (!e || e->used)
+        return;
+    e->used = 1;
+    for (int i = 0; i < e->nchildren; i++)
+        keep(c, cache_find(c, e->children[i]));
+}
+
+// Subprogramas da árvore na ordem do código gerado, para achar um subprograma
+// pelo endereço de entrada
+typedef struct
+{
+    NODE **procs;
+    int count, capacity;
+} PROCLIST;
+
+static void collect(PROCLIST *list, NODE *subprogs)
+{
+    for (NODE *proc = subprogs; proc; proc = proc->next)
+    {
+        if (list->count == list->capacity)
+        {
+            list->capacity = list->capacity ? 2 * list->capacity : 64;
+            list->procs = realloc(list->procs, list->capacity * sizeof(NODE *));
+            if (!list->procs)
+            {
+                fprintf(stderr, "Erro: memória insuficiente.\n");
+                exit(EXIT_FAILURE);
+            }
+        }
+        list->procs[list->count++] = proc;
+        if (proc->u.decl.block)
+            collect(list, proc->u.decl.block->u.blk.subprogs);
+    }
+}
+
+/**
+ * Subprograma cujo código começa em `offset`. Como a lista segue a ordem de
+ * geração, os endereços de entrada são crescentes.
+ */
+static NODE *lookup(PROCLIST *list, long offset)
+{
+    int lo = 0, hi = list->count - 1;
+    while (lo <= hi)
+    {
+        int mid = (lo + hi) / 2;
+        long entry = list->procs[mid]->u.decl.offset;
+        if (entry == offset)
+            return list->procs[mid];
+        if (entry < offset)
+            lo = mid + 1;
+        else
+            hi = mid - 1;
+    }
+    return NULL;
+}
+
+/**
+ * Guarda o código de um subprograma analisado nesta compilação. Retorna NULL
+ * se alguma chamada externa não puder ser relocada.
+ */
+static CACHEENTRY *record(PROCLIST *list, NODE *proc)
+{
+    PROCACHE *pc = proc->u.decl.cache;
+    int start = proc->u.decl.offset;
+    int ninstr = pc->end - start;
+    int nchildren = 0, nrelocs = 0;
+
+    for (NODE *sub = proc->u.decl.block->u.blk.subprogs; sub; sub = sub->next)
+        nchildren += sub->u.decl.cache->key != 0;
+    for (int i = start; i < pc->end; i++)
+        nrelocs += code[i].op == OP_CAL && code[i].arg < start;
+
+    CACHEENTRY *e = newentry(pc->key, ninstr, nchildren, nrelocs);
+    nchildren = nrelocs = 0;
+    for (NODE *sub = proc->u.decl.block->u.blk.subprogs; sub; sub = sub->next)
+        if (sub->u.decl.cache->key)
+            e->children[nchildren++] = sub->u.decl.cache->key;
+
+    for (int i = 0; i < ninstr; i++)
+    {
+        INSTR in = code[start + i];
+        if (in.op == OP_CAL && in.arg < start)
+        {
+            // Chamada a um subprograma externo: declarado antes, ou que envolve este
+            NODE *callee = lookup(list, in.arg);
+            if (!callee)
+            {
+                free(e);
+                return NULL;
+            }
+            e->relocs[nrelocs].at = i;
+            e->relocs[nrelocs++].symbol = callee->u.decl.cache->symbol;
+        }
+        else if (in.op == OP_JMP || in.op == OP_JPC || in.op == OP_CAL)
+        {
+            in.arg -= start;
+        }
+        e->code[i] = in;
+    }
+    return e;
+}
+
+/**
+ * Grava o cache após uma compilação bem-sucedida, com o código dos subprogramas
+ * analisados nesta compilação e as entradas reaproveitadas. Entradas que não
+ * foram usadas pertencem a versões antigas do fonte e são descartadas. O
+ * arquivo é escrito ao lado e renomeado, de modo que uma gravação interrompida
+ * não deixa um cache corrompido.
+ */
+void cache_commit(CACHE *c, NODE *program)
+{
+    PROCLIST list = {NULL, 0, 0};
+    collect(&list, program->u.blk.body->u.blk.subprogs);
+
+    for (int i = 0; i < list.count; i++)
+    {
+        PROCACHE *pc = list.procs[i]->u.decl.cache;
+        if (pc->entry)
+        {
+            keep(c, pc->entry);
+        }
+        else if (pc->key && !cache_find(c, pc->key))
+        {
+            CACHEENTRY *e = record(&list, list.procs[i]);
+            if (e)
+            {
+                insert(c, e);
+                e->used = 1;
+                c->changed = 1;
+            }
+        }
+    }
+    free(list.procs);
+
+    // Nada a gravar se não houve subprogramas novos nem entradas descartadas
+    int count = 0;
+    for (int b = 0; b < c->nbuckets; b++)
+        for (CACHEENTRY *e = c->buckets[b]; e; e = e->next)
+            count += e->used;
+    if (!c->changed && count == c->count)
+        return;
+
+    char *tmp = xmalloc(strlen(c->path) + sizeof(".tmp"));
+    sprintf(tmp, "%s.tmp", c->path);
+    FILE *out = fopen(tmp, "wb");
+    if (!out)
+    {
+        perror("Erro ao gravar o cache");
+        free(tmp);
+        return;
+    }
+
+    fwrite(CACHE_MAGIC, sizeof(CACHE_MAGIC), 1, out);
+    fwrite(&count, sizeof(count), 1, out);
+    for (int b = 0; b < c->nbuckets; b++)
+    {
+        for (CACHEENTRY *e = c->buckets[b]; e; e = e->next)
+        {
+            if (!e->used)
+                continue;
+            int sizes[3] = {e->ninstr, e->nchildren, e->nrelocs};
+            HASH check = checksum(e);
+            fwrite(&e->key, sizeof(e->key), 1, out);
+            fwrite(&check, sizeof(check), 1, out);
+            fwrite(sizes, sizeof(sizes), 1, out);
+            fwrite(e->code, sizeof(INSTR), e->ninstr, out);
+            fwrite(e->children, sizeof(HASH), e->nchildren, out);
+            fwrite(e->relocs, sizeof(RELOC), e->nrelocs, out);
+        }
+    }
+
+    if (fclose(out) != 0 || rename(tmp, c->path) != 0)
+    {
+        perror("Erro ao gravar o cache");
+        remove(tmp);
+    }
+    free(tmp);
+}
+
+/**
+ * Libera as entradas do cache.
+ */
+void cache_free(CACHE *c)
+{
+    clear(c);
+    free(c->path);
+    memset(c, 0, sizeof(*c));
+}
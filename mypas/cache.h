@@ -0,0 +1,70 @@
+// cache.h
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <stddef.h>
+#include "ast.h"
+#include "codegen.h"
+
+// Hash de 64 bits (FNV-1a) usado nas chaves do cache
+typedef unsigned long long HASH;
+
+#define HASH_SEED 14695981039346656037ULL
+
+// Chamada a um subprograma declarado fora do subprograma guardado: o endereço
+// de entrada muda de uma compilação para outra e é refeito a partir do índice
+// do chamado na tabela de símbolos, que é o mesmo enquanto o ambiente não mudar
+typedef struct
+{
+    int at;     // Instrução OP_CAL, relativa ao início do subprograma
+    int symbol; // Índice do subprograma chamado na tabela de símbolos
+} RELOC;
+
+// Código gerado de um subprograma (com os aninhados), guardado entre compilações.
+// Os desvios e as chamadas internas ficam relativos ao início do subprograma.
+typedef struct _cacheentry_
+{
+    HASH key;                   // Hash do texto do subprograma e do ambiente em que foi declarado
+    int used;                   // 1 se deve ser mantido no arquivo ao final da compilação
+    int ninstr;                 // Número de instruções
+    int nrelocs;                // Número de chamadas externas
+    int nchildren;              // Número de subprogramas aninhados diretamente
+    INSTR *code;                // Instruções
+    HASH *children;             // Chaves dos subprogramas aninhados, mantidos junto com este
+    RELOC *relocs;              // Chamadas externas, em ordem crescente de instrução
+    struct _cacheentry_ *next;  // Próxima entrada no mesmo bucket
+} CACHEENTRY;
+
+// Cache incremental de um arquivo fonte, lido de <arquivo-fonte>.cache
+typedef struct
+{
+    char *path;            // Arquivo do cache
+    CACHEENTRY **buckets;  // Índice hash das entradas
+    int nbuckets;          // Número de buckets (potência de 2)
+    int count;             // Número de entradas
+    int changed;           // 1 se o arquivo precisa ser regravado
+} CACHE;
+
+// Situação de um subprograma da árvore em relação ao cache (NODE_PROC)
+typedef struct _procache_
+{
+    HASH key;          // Chave do subprograma (0 se não pode ser guardado)
+    int symbol;        // Índice do subprograma na tabela de símbolos
+    int end;           // Fim do código gerado nesta compilação (falta)
+    CACHEENTRY *entry; // Código reaproveitado (acerto) ou NULL (falta)
+    NODE **callees;    // Subprogramas chamados pelas realocações de `entry`
+} PROCACHE;
+
+// Cache da compilação corrente (NULL sem --cache)
+extern _Thread_local CACHE *cache;
+
+HASH hash_bytes(HASH h, const void *data, size_t size);
+HASH hash_int(HASH h, long value);
+
+void cache_open(CACHE *c, const char *source);
+CACHEENTRY *cache_find(CACHE *c, HASH key);
+void cache_emit(NODE *proc);
+void cache_commit(CACHE *c, NODE *program);
+void cache_free(CACHE *c);
+
+#endif
@@ -0,0 +1,337 @@
+// check.c
+// Verificação de tipos: percorre a árvore depois da análise sintática, anota
+// cada expressão com o seu tipo (INTEGER, REAL ou BOOLEAN) e insere nós
+// NODE_CONV onde um inteiro é usado como real. Com a árvore verificada, a
+// geração de código escolhe as instruções inteiras ou reais pelo tipo dos
+// operandos, sem testes em tempo de execução.
+#include <stdio.h>
+#include <stdlib.h>
+#include "check.h"
+#include "lexer.h"
+#include "keywords.h"
+#include "symtab.h"
+#include "driver.h"
+
+// Cadeia dos subprogramas cujo corpo está sendo verificado, do mais interno ao mais externo
+typedef struct _scope_
+{
+    NODE *proc;
+    struct _scope_ *outer;
+} SCOPE;
+
+static _Thread_local SCOPE *scope = NULL;
+
+static void check_stmt(NODE *stmt);
+static void check_expr(NODE *expr);
+
+/**
+ * Interrompe a compilação com uma mensagem de erro semântico sobre um nome.
+ */
+static void check_error(NODE *node, const char *message, const char *name)
+{
+    compile_error("Erro semântico na linha %d: %s '%s'.", node->line, message, name);
+    compile_abort();
+}
+
+/**
+ * Tipo usado nas expressões para um tipo declarado: DOUBLE tem a mesma
+ * representação que REAL.
+ */
+static int basetype(int type)
+{
+    return type == DOUBLE ? REAL : type;
+}
+
+// Verdadeiro para os tipos aceitos nas operações aritméticas
+#define NUMERIC(type) ((type) == INTEGER || (type) == REAL)
+
+/**
+ * Nome de um operador, para as mensagens de erro.
+ */
+static const char *opname(int op)
+{
+    switch (op)
+    {
+    case '+': return "+";
+    case '-': return "-";
+    case '*': return "*";
+    case '/': return "/";
+    case '=': return "=";
+    case '<': return "<";
+    case '>': return ">";
+    case RELOP_LE: return "<=";
+    case RELOP_GE: return ">=";
+    case RELOP_NE: return "<>";
+    default: return keywords[op - BEGIN]; // and, or, not, div e mod
+    }
+}
+
+/**
+ * Envolve uma expressão inteira numa conversão para real. O nó de conversão
+ * ocupa o lugar da expressão, inclusive numa lista de argumentos.
+ */
+static NODE *widen(NODE *expr)
+{
+    NODE *conv = newnode(NODE_CONV, expr->line);
+    conv->type = REAL;
+    conv->u.bin.left = expr;
+    conv->next = expr->next;
+    expr->next = NULL;
+    return conv;
+}
+
+/**
+ * Adapta uma expressão já verificada ao tipo declarado `type`: inteiros são
+ * convertidos para real; qualquer outra diferença é um erro.
+ * Retorna a expressão, possivelmente envolvida numa conversão.
+ */
+static NODE *convert(NODE *expr, int type, const char *message, const char *name)
+{
+    type = basetype(type);
+    if (expr->type == type)
+        return expr;
+    if (type == REAL && expr->type == INTEGER)
+        return widen(expr);
+    check_error(expr, message, name);
+    return expr;
+}
+
+/**
+ * Verifica os argumentos de uma chamada contra os parâmetros do subprograma:
+ * argumentos por referência precisam ser variáveis do mesmo tipo, e os
+ * demais são convertidos como numa atribuição.
+ */
+static void check_args(NODE *call)
+{
+    NODE *proc = call->u.ref.decl;
+    NODE *parm = proc->u.decl.params;
+    NODE **link = &call->u.ref.args;
+
+    for (; parm && *link; parm = parm->next, link = &(*link)->next)
+    {
+        NODE *arg = *link;
+        if (parm->u.decl.parmflag)
+        {
+            if (arg->kind != NODE_VARREF || arg->u.ref.decl->kind != NODE_VAR)
+                check_error(arg, "argumento por referência não é uma variável em chamada a", proc->u.decl.name);
+            check_expr(arg);
+            if (arg->type != basetype(parm->type))
+                check_error(arg, "argumento por referência de tipo diferente do parâmetro em chamada a", proc->u.decl.name);
+        }
+        else
+        {
+            check_expr(arg);
+            *link = convert(arg, parm->type, "argumento de tipo incompatível em chamada a", proc->u.decl.name);
+        }
+    }
+
+    if (parm || *link)
+        check_error(call, "número de argumentos incorreto na chamada a", proc->u.decl.name);
+}
+
+/**
+ * Verifica uma operação binária e determina o seu tipo. Operações aritméticas
+ * com um operando real convertem o outro; '/' sempre produz real.
+ */
+static void check_binop(NODE *expr)
+{
+    NODE *left = expr->u.bin.left, *right = expr->u.bin.right;
+    check_expr(left);
+    check_expr(right);
+    int lt = left->type, rt = right->type;
+
+    switch (expr->op)
+    {
+    case '+':
+    case '-':
+    case '*':
+    case '/':
+        if (!NUMERIC(lt) || !NUMERIC(rt))
+            break;
+        expr->type = (lt == REAL || rt == REAL || expr->op == '/') ? REAL : INTEGER;
+        break;
+    case DIV:
+    case MOD:
+        if (lt == INTEGER && rt == INTEGER)
+            expr->type = INTEGER;
+        break;
+    case AND:
+    case OR:
+        if (lt == BOOLEAN && rt == BOOLEAN)
+            expr->type = BOOLEAN;
+        break;
+    default: // Operadores relacionais
+        if ((NUMERIC(lt) && NUMERIC(rt)) || (lt == BOOLEAN && rt == BOOLEAN))
+            expr->type = BOOLEAN;
+        break;
+    }
+    if (!expr->type)
+        check_error(expr, "operandos de tipos incompatíveis com o operador", opname(expr->op));
+
+    // Operandos inteiros de uma operação real são convertidos
+    if (NUMERIC(lt) && (lt != rt || expr->op == '/'))
+    {
+        if (lt == INTEGER)
+            expr->u.bin.left = widen(left);
+        if (rt == INTEGER)
+            expr->u.bin.right = widen(right);
+    }
+}
+
+/**
+ * Verifica uma expressão, anotando em `type` o tipo do seu valor.
+ */
+static void check_expr(NODE *expr)
+{
+    switch (expr->kind)
+    {
+    case NODE_NUM:
+        expr->type = INTEGER;
+        break;
+    case NODE_VARREF:
+    {
+        NODE *var = expr->u.ref.decl;
+        if (var->kind != NODE_VAR)
+            check_error(expr, "não é uma variável", var->u.decl.name);
+        expr->type = basetype(var->type);
+        break;
+    }
+    case NODE_CALL:
+    {
+        NODE *proc = expr->u.ref.decl;
+        if (proc->kind != NODE_PROC || proc->u.decl.objtype != FUNCTION_OBJ)
+            check_error(expr, "não é uma função", proc->u.decl.name);
+        check_args(expr);
+        expr->type = basetype(proc->type);
+        break;
+    }
+    case NODE_UNOP:
+        check_expr(expr->u.bin.left);
+        if (expr->u.bin.left->type != BOOLEAN)
+            check_error(expr, "operando de tipo incompatível com o operador", opname(expr->op));
+        expr->type = BOOLEAN;
+        break;
+    case NODE_BINOP:
+        check_binop(expr);
+        break;
+    }
+}
+
+/**
+ * Verifica a condição de um IF, WHILE ou REPEAT, que precisa ser booleana.
+ */
+static void check_cond(NODE *stmt, const char *name)
+{
+    check_expr(stmt->u.ctl.cond);
+    if (stmt->u.ctl.cond->type != BOOLEAN)
+        check_error(stmt->u.ctl.cond, "condição não booleana no comando", name);
+}
+
+/**
+ * Verifica uma atribuição a variável, parâmetro ou nome de função. O nome de
+ * uma função só recebe valor dentro do seu próprio corpo.
+ */
+static void check_assign(NODE *assign)
+{
+    NODE *target = assign->u.ref.decl;
+
+    if (target->kind == NODE_PROC)
+    {
+        SCOPE *sc = scope;
+        while (sc && sc->proc != target)
+            sc = sc->outer;
+        if (!sc || target->u.decl.objtype != FUNCTION_OBJ)
+            check_error(assign, "atribuição fora do corpo da função", target->u.decl.name);
+    }
+
+    check_expr(assign->u.ref.args);
+    assign->u.ref.args = convert(assign->u.ref.args, target->type, "valor de tipo incompatível atribuído a", target->u.decl.name);
+}
+
+/**
+ * Verifica uma lista de comandos.
+ */
+static void check_stmtlist(NODE *list)
+{
+    for (NODE *stmt = list; stmt; stmt = stmt->next)
+        check_stmt(stmt);
+}
+
+/**
+ * Verifica um comando.
+ */
+static void check_stmt(NODE *stmt)
+{
+    switch (stmt->kind)
+    {
+    case NODE_COMPOUND:
+        check_stmtlist(stmt->u.list);
+        break;
+    case NODE_ASSIGN:
+        check_assign(stmt);
+        break;
+    case NODE_CALL:
+    {
+        NODE *proc = stmt->u.ref.decl;
+        if (proc->kind != NODE_PROC)
+            check_error(stmt, "não é um procedimento ou função", proc->u.decl.name);
+        if (proc->op) // Procedimento predefinido: aceita valores de qualquer tipo
+        {
+            for (NODE *arg = stmt->u.ref.args; arg; arg = arg->next)
+                check_expr(arg);
+            break;
+        }
+        check_args(stmt);
+        break;
+    }
+    case NODE_IF:
+        check_cond(stmt, "if");
+        check_stmt(stmt->u.ctl.then);
+        if (stmt->u.ctl.els)
+            check_stmt(stmt->u.ctl.els);
+        break;
+    case NODE_WHILE:
+        check_cond(stmt, "while");
+        check_stmt(stmt->u.ctl.then);
+        break;
+    case NODE_REPEAT:
+        check_stmtlist(stmt->u.ctl.then);
+        check_cond(stmt, "repeat");
+        break;
+    }
+}
+
+static void check_block(NODE *blk);
+
+/**
+ * Verifica um procedimento ou função e os subprogramas aninhados nele.
+ */
+static void check_proc(NODE *proc)
+{
+    if (!proc->u.decl.block)
+        return; // Reaproveitado do cache: já verificado numa compilação anterior
+    SCOPE inner = {proc, scope};
+    scope = &inner;
+    check_block(proc->u.decl.block);
+    scope = inner.outer;
+}
+
+/**
+ * Verifica os subprogramas e o corpo de um bloco.
+ */
+static void check_block(NODE *blk)
+{
+    for (NODE *proc = blk->u.blk.subprogs; proc; proc = proc->next)
+        check_proc(proc);
+    check_stmt(blk->u.blk.body);
+}
+
+/**
+ * Verifica os tipos do programa completo, anotando a árvore para a geração
+ * de código. Erros interrompem a compilação.
+ */
+void typecheck(NODE *program)
+{
+    scope = NULL; // Uma compilação interrompida pode ter deixado a cadeia incompleta
+    check_block(program->u.blk.body);
+}
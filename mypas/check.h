@@ -0,0 +1,9 @@
+// check.h
+#ifndef CHECK_H
+#define CHECK_H
+
+#include "ast.h"
+
+void typecheck(NODE *program);
+
+#endif
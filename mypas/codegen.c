@@ -0,0 +1,416 @@
+// codegen.c
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "codegen.h"
+#include "lexer.h"
+#include "keywords.h"
+#include "symtab.h"
+#include "cache.h"
+
+_Thread_local INSTR *code = NULL;     // Programa gerado
+_Thread_local int codesize = 0;       // Número de instruções geradas
+static _Thread_local int codecap = 0; // Capacidade atual do vetor de instruções
+
+// Nível léxico do código que está sendo gerado
+static _Thread_local int level = 0;
+
+// Profundidade da pilha de operandos no ponto corrente do bloco em geração e a
+// maior já alcançada nele, gravada no OP_INT de entrada do bloco
+static _Thread_local int depth = 0;
+static _Thread_local int maxdepth = 0;
+
+// Efeito de cada instrução sobre a pilha de operandos, na ordem do enum de
+// codegen.h. OP_INT soma arg; OP_CAL é ajustado pela chamada, que conhece o
+// número de argumentos descartados pelo OP_RET do chamado.
+static const signed char effects[] = {
+    1, 1, -1, 1, 0, -2, 0,
+    -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, 0,
+    -1, -1, 0,
+    -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1,
+    0, -1, 0, 0, -1, -1, 0, 0};
+
+// Mnemônicos das instruções, na ordem do enum de codegen.h
+static const char *mnemonics[] = {
+    "LIT", "LOD", "STO", "LDA", "LDI", "STI", "INT",
+    "ADD", "SUB", "MUL", "IDIV", "MOD",
+    "RADD", "RSUB", "RMUL", "RDIV", "FLT",
+    "AND", "OR", "NOT",
+    "EQL", "NEQ", "LSS", "LEQ", "GTR", "GEQ",
+    "REQL", "RNEQ", "RLSS", "RLEQ", "RGTR", "RGEQ",
+    "JMP", "JPC", "CAL", "RET", "WRT", "RWRT", "WRL", "HLT"};
+
+static void gen_stmt(NODE *stmt);
+static void gen_expr(NODE *expr);
+
+/**
+ * Garante espaço para mais `n` instruções no programa gerado.
+ */
+static void reserve(int n)
+{
+    if (codesize + n > codecap) // Aumenta o vetor de instruções quando necessário
+    {
+        while (codesize + n > codecap)
+            codecap = codecap ? 2 * codecap : 1024;
+        code = realloc(code, codecap * sizeof(INSTR));
+        if (!code)
+        {
+            fprintf(stderr, "Erro: memória insuficiente para o código gerado.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+}
+
+/**
+ * Acrescenta uma instrução ao programa gerado.
+ * Retorna o índice da instrução, usado para completar desvios posteriormente.
+ */
+int emit(int op, int level, long arg)
+{
+    reserve(1);
+    depth += op == OP_INT ? arg : effects[op];
+    if (depth > maxdepth)
+        maxdepth = depth;
+
+    code[codesize].op = op;
+    code[codesize].level = level;
+    code[codesize].arg = arg;
+    return codesize++;
+}
+
+/**
+ * Acrescenta `n` instruções prontas ao programa gerado, retornando o índice
+ * da primeira.
+ */
+int emit_block(const INSTR *block, int n)
+{
+    reserve(n);
+    memcpy(code + codesize, block, n * sizeof(INSTR));
+    codesize += n;
+    return codesize - n;
+}
+
+/**
+ * Atribui deslocamentos às variáveis locais de um bloco, logo após o cabeçalho
+ * do registro de ativação. Retorna o número de variáveis.
+ */
+static int alloc_locals(NODE *vars)
+{
+    int n = 0;
+    for (NODE *var = vars; var; var = var->next)
+        var->u.decl.offset = FRAME_HEADER + n++;
+    return n;
+}
+
+/**
+ * Gera o código dos argumentos de uma chamada: valores para parâmetros comuns
+ * e endereços para parâmetros por referência. A verificação de tipos já
+ * garantiu que os argumentos correspondem aos parâmetros.
+ */
+static void gen_args(NODE *call)
+{
+    NODE *proc = call->u.ref.decl;
+    NODE *parm = proc->u.decl.params;
+    NODE *arg = call->u.ref.args;
+
+    for (; parm && arg; parm = parm->next, arg = arg->next)
+    {
+        if (parm->u.decl.parmflag)
+        {
+            NODE *var = arg->u.ref.decl;
+            if (var->u.decl.parmflag)
+                emit(OP_LOD, level - var->u.decl.lexlevel, var->u.decl.offset); // Repassa o endereço recebido
+            else
+                emit(OP_LDA, level - var->u.decl.lexlevel, var->u.decl.offset);
+        }
+        else
+        {
+            gen_expr(arg);
+        }
+    }
+}
+
+/**
+ * Gera uma chamada de subprograma. Para funções, uma célula é reservada
+ * abaixo dos argumentos para o valor de retorno.
+ */
+static void gen_call(NODE *call)
+{
+    NODE *proc = call->u.ref.decl;
+
+    if (proc->u.decl.objtype == FUNCTION_OBJ)
+        emit(OP_INT, 0, 1); // Reserva o valor de retorno
+    gen_args(call);
+    emit(OP_CAL, level - proc->u.decl.lexlevel, proc->u.decl.offset);
+    depth -= proc->u.decl.nparams; // Descartados pelo OP_RET do chamado
+}
+
+/**
+ * Gera o código de uma expressão, deixando seu valor no topo da pilha.
+ */
+static void gen_expr(NODE *expr)
+{
+    switch (expr->kind)
+    {
+    case NODE_NUM:
+        emit(OP_LIT, 0, expr->u.value);
+        break;
+    case NODE_VARREF:
+    {
+        NODE *var = expr->u.ref.decl;
+        emit(OP_LOD, level - var->u.decl.lexlevel, var->u.decl.offset);
+        if (var->u.decl.parmflag)
+            emit(OP_LDI, 0, 0); // Parâmetro por referência guarda um endereço
+        break;
+    }
+    case NODE_CALL:
+        gen_call(expr);
+        break;
+    case NODE_CONV:
+        gen_expr(expr->u.bin.left);
+        emit(OP_FLT, 0, 0);
+        break;
+    case NODE_UNOP:
+        gen_expr(expr->u.bin.left);
+        emit(OP_NOT, 0, 0);
+        break;
+    case NODE_BINOP:
+    {
+        gen_expr(expr->u.bin.left);
+        gen_expr(expr->u.bin.right);
+        // Os dois operandos têm o mesmo tipo após a verificação de tipos
+        int real = expr->u.bin.left->type == REAL;
+        switch (expr->op)
+        {
+        case '+': emit(real ? OP_RADD : OP_ADD, 0, 0); break;
+        case '-': emit(real ? OP_RSUB : OP_SUB, 0, 0); break;
+        case '*': emit(real ? OP_RMUL : OP_MUL, 0, 0); break;
+        case '/': emit(OP_RDIV, 0, 0); break;
+        case DIV: emit(OP_IDIV, 0, 0); break;
+        case MOD: emit(OP_MOD, 0, 0); break;
+        case AND: emit(OP_AND, 0, 0); break;
+        case OR: emit(OP_OR, 0, 0); break;
+        case '=': emit(real ? OP_REQL : OP_EQL, 0, 0); break;
+        case RELOP_NE: emit(real ? OP_RNEQ : OP_NEQ, 0, 0); break;
+        case '<': emit(real ? OP_RLSS : OP_LSS, 0, 0); break;
+        case RELOP_LE: emit(real ? OP_RLEQ : OP_LEQ, 0, 0); break;
+        case '>': emit(real ? OP_RGTR : OP_GTR, 0, 0); break;
+        case RELOP_GE: emit(real ? OP_RGEQ : OP_GEQ, 0, 0); break;
+        }
+        break;
+    }
+    }
+}
+
+/**
+ * Gera o código de uma atribuição a variável, parâmetro ou nome de função.
+ */
+static void gen_assign(NODE *assign)
+{
+    NODE *target = assign->u.ref.decl;
+
+    if (target->kind == NODE_PROC)
+    {
+        // O valor de retorno fica na célula reservada abaixo dos parâmetros,
+        // no registro de ativação da própria função
+        int body_level = target->u.decl.lexlevel + 1;
+        gen_expr(assign->u.ref.args);
+        emit(OP_STO, level - body_level, -(target->u.decl.nparams + 1));
+    }
+    else if (target->u.decl.parmflag)
+    {
+        emit(OP_LOD, level - target->u.decl.lexlevel, target->u.decl.offset); // Endereço da variável
+        gen_expr(assign->u.ref.args);
+        emit(OP_STI, 0, 0);
+    }
+    else
+    {
+        gen_expr(assign->u.ref.args);
+        emit(OP_STO, level - target->u.decl.lexlevel, target->u.decl.offset);
+    }
+}
+
+/**
+ * Gera o código de uma lista de comandos.
+ */
+static void gen_stmtlist(NODE *list)
+{
+    for (NODE *stmt = list; stmt; stmt = stmt->next)
+        gen_stmt(stmt);
+}
+
+/**
+ * Gera o código de um comando.
+ */
+static void gen_stmt(NODE *stmt)
+{
+    switch (stmt->kind)
+    {
+    case NODE_COMPOUND:
+        gen_stmtlist(stmt->u.list);
+        break;
+    case NODE_ASSIGN:
+        gen_assign(stmt);
+        break;
+    case NODE_CALL:
+    {
+        NODE *proc = stmt->u.ref.decl;
+        if (proc->kind == NODE_PROC && proc->op) // Procedimento predefinido
+        {
+            for (NODE *arg = stmt->u.ref.args; arg; arg = arg->next)
+            {
+                gen_expr(arg);
+                emit(arg->type == REAL ? OP_RWRT : OP_WRT, 0, arg != stmt->u.ref.args); // Separa os valores por um espaço
+            }
+            if (proc->op == BUILTIN_WRITELN)
+                emit(OP_WRL, 0, 0);
+            break;
+        }
+        gen_call(stmt);
+        if (proc->u.decl.objtype == FUNCTION_OBJ)
+            emit(OP_INT, 0, -1); // Descarta o valor de retorno
+        break;
+    }
+    case NODE_IF:
+    {
+        gen_expr(stmt->u.ctl.cond);
+        int jpc = emit(OP_JPC, 0, 0);
+        gen_stmt(stmt->u.ctl.then);
+        if (stmt->u.ctl.els)
+        {
+            int jmp = emit(OP_JMP, 0, 0);
+            code[jpc].arg = codesize;
+            gen_stmt(stmt->u.ctl.els);
+            code[jmp].arg = codesize;
+        }
+        else
+        {
+            code[jpc].arg = codesize;
+        }
+        break;
+    }
+    case NODE_WHILE:
+    {
+        int start = codesize;
+        gen_expr(stmt->u.ctl.cond);
+        int jpc = emit(OP_JPC, 0, 0);
+        gen_stmt(stmt->u.ctl.then);
+        emit(OP_JMP, 0, start);
+        code[jpc].arg = codesize;
+        break;
+    }
+    case NODE_REPEAT:
+    {
+        int start = codesize;
+        gen_stmtlist(stmt->u.ctl.then);
+        gen_expr(stmt->u.ctl.cond);
+        emit(OP_JPC, 0, start);
+        break;
+    }
+    }
+}
+
+static void gen_subprogs(NODE *subprogs);
+
+/**
+ * Gera o código de um procedimento ou função.
+ * Os parâmetros ficam abaixo do registro de ativação (deslocamentos negativos)
+ * e as variáveis locais logo após o cabeçalho.
+ */
+static void gen_proc(NODE *proc)
+{
+    NODE *blk = proc->u.decl.block;
+    int saved = level;
+    level = proc->u.decl.lexlevel + 1;
+
+    int n = 0;
+    for (NODE *parm = proc->u.decl.params; parm; parm = parm->next)
+        n++;
+    proc->u.decl.nparams = n;
+    int i = 0;
+    for (NODE *parm = proc->u.decl.params; parm; parm = parm->next)
+        parm->u.decl.offset = i++ - n;
+
+    if (proc->u.decl.cache && proc->u.decl.cache->entry)
+    {
+        cache_emit(proc); // Código guardado numa compilação anterior
+        level = saved;
+        return;
+    }
+
+    // Os deslocamentos das variáveis locais e o endereço de entrada precisam ser
+    // conhecidos antes dos subprogramas aninhados, que podem usá-los
+    int nlocals = alloc_locals(blk->u.blk.vars);
+    proc->u.decl.offset = codesize;
+    if (blk->u.blk.subprogs)
+    {
+        int jmp = emit(OP_JMP, 0, 0);
+        gen_subprogs(blk->u.blk.subprogs);
+        code[jmp].arg = codesize;
+    }
+
+    int entry = emit(OP_INT, 0, nlocals); // O cabeçalho já foi empilhado por OP_CAL
+    depth = maxdepth = 0;
+    gen_stmt(blk->u.blk.body);
+    code[entry].level = maxdepth;
+    emit(OP_RET, 0, n);
+    if (proc->u.decl.cache)
+        proc->u.decl.cache->end = codesize; // Fim do código a guardar no cache
+
+    level = saved;
+}
+
+/**
+ * Gera o código de uma lista de subprogramas.
+ */
+static void gen_subprogs(NODE *subprogs)
+{
+    for (NODE *proc = subprogs; proc; proc = proc->next)
+        gen_proc(proc);
+}
+
+/**
+ * Gera o código do programa completo. A execução começa na instrução 0,
+ * que desvia para o corpo principal; o registro de ativação do programa
+ * (nível 0) guarda as variáveis globais. A árvore precisa ter passado pela
+ * verificação de tipos (typecheck).
+ */
+void codegen(NODE *program)
+{
+    NODE *blk = program->u.blk.body;
+
+    codesize = 0;
+    level = 0;
+
+    int nglobals = alloc_locals(blk->u.blk.vars);
+    int jmp = emit(OP_JMP, 0, 0);
+    gen_subprogs(blk->u.blk.subprogs);
+    code[jmp].arg = codesize;
+
+    int entry = emit(OP_INT, 0, FRAME_HEADER + nglobals);
+    depth = maxdepth = 0;
+    gen_stmt(blk->u.blk.body);
+    code[entry].level = maxdepth;
+    emit(OP_HLT, 0, 0);
+}
+
+/**
+ * Escreve o programa gerado em formato texto, uma instrução por linha.
+ */
+void codegen_write(FILE *out)
+{
+    for (int i = 0; i < codesize; i++)
+        fprintf(out, "%6d  %-4s %d, %ld\n", i, mnemonics[code[i].op], code[i].level, code[i].arg);
+}
+
+/**
+ * Libera o vetor de instruções da thread corrente.
+ */
+void codegen_free(void)
+{
+    free(code);
+    code = NULL;
+    codesize = codecap = 0;
+}
@@ -0,0 +1,76 @@
+// codegen.h
+#ifndef CODEGEN_H
+#define CODEGEN_H
+
+#include <stdio.h>
+#include "ast.h"
+
+// Células reservadas no início de cada registro de ativação:
+// elo estático, elo dinâmico e endereço de retorno
+#define FRAME_HEADER 3
+
+// Instruções da máquina de pilha. `level` é a diferença de níveis léxicos
+// (número de elos estáticos a seguir) e `arg` o deslocamento, endereço ou constante.
+enum
+{
+    OP_LIT,  // Empilha a constante arg
+    OP_LOD,  // Empilha a variável (level, arg)
+    OP_STO,  // Desempilha para a variável (level, arg)
+    OP_LDA,  // Empilha o endereço absoluto da variável (level, arg)
+    OP_LDI,  // Substitui o endereço do topo pelo valor nele armazenado
+    OP_STI,  // Desempilha valor e endereço e armazena o valor no endereço
+    OP_INT,  // Soma arg ao topo da pilha (reserva, zerando, ou descarta células); na
+             // entrada de um bloco, level é a profundidade máxima dos temporários do bloco
+    OP_ADD,  // Operações aritméticas inteiras sobre os dois valores do topo
+    OP_SUB,
+    OP_MUL,
+    OP_IDIV, // Divisão inteira ('div')
+    OP_MOD,
+    OP_RADD, // Operações aritméticas reais
+    OP_RSUB,
+    OP_RMUL,
+    OP_RDIV, // Divisão real ('/')
+    OP_FLT,  // Converte o inteiro do topo para real
+    OP_AND,  // Operações lógicas
+    OP_OR,
+    OP_NOT,
+    OP_EQL,  // Comparações de inteiros ou booleanos; deixam 1 (verdadeiro) ou 0 (falso)
+    OP_NEQ,
+    OP_LSS,
+    OP_LEQ,
+    OP_GTR,
+    OP_GEQ,
+    OP_REQL, // Comparações de reais
+    OP_RNEQ,
+    OP_RLSS,
+    OP_RLEQ,
+    OP_RGTR,
+    OP_RGEQ,
+    OP_JMP,  // Desvia para arg
+    OP_JPC,  // Desempilha e desvia para arg se o valor for falso
+    OP_CAL,  // Empilha o cabeçalho do registro (elo estático a level níveis) e desvia para arg
+    OP_RET,  // Retorna de um subprograma, descartando o registro e arg parâmetros
+    OP_WRT,  // Desempilha e escreve o inteiro (precedido de um espaço se arg for 1)
+    OP_RWRT, // Desempilha e escreve o real (precedido de um espaço se arg for 1)
+    OP_WRL,  // Escreve uma quebra de linha
+    OP_HLT,  // Encerra a execução
+};
+
+// Instrução da máquina de pilha
+typedef struct _instr_
+{
+    int op;
+    int level;
+    long arg;
+} INSTR;
+
+extern _Thread_local INSTR *code; // Programa gerado
+extern _Thread_local int codesize; // Número de instruções geradas
+
+int emit(int op, int level, long arg);
+int emit_block(const INSTR *block, int n);
+void codegen(NODE *program);
+void codegen_write(FILE *out);
+void codegen_free(void);
+
+#endif
@@ -0,0 +1,240 @@
+// driver.c
+// Compilação de vários arquivos em paralelo. Cada thread trabalhadora tem uma
+// fila dupla de arquivos: retira o próximo do fim da própria fila e, quando ela
+// se esgota, rouba do início da fila de outra thread, de modo que arquivos
+// grandes numa fila não deixam as demais threads ociosas.
+#include <errno.h>
+#include <stdarg.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "driver.h"
+#include "parser.h"
+#include "tokens.h"
+#include "check.h"
+#include "codegen.h"
+#include "cache.h"
+
+extern _Thread_local LEXER lexer;   // Analisador léxico do arquivo fonte
+
+_Thread_local CONTEXT *current_context = NULL;
+
+// Fila dupla de índices de compilações: a dona retira de `bottom`, os ladrões de `top`
+typedef struct
+{
+    pthread_mutex_t lock;
+    int *jobs;
+    int top, bottom; // Compilações pendentes em jobs[top..bottom)
+} DEQUE;
+
+// Argumentos de uma thread trabalhadora
+typedef struct
+{
+    int self;      // Índice da fila da thread
+    int nthreads;  // Número total de filas
+    DEQUE *deques; // Filas de todas as threads
+    CONTEXT *jobs; // Compilações, indexadas pelos valores das filas
+} WORKER;
+
+/**
+ * Interrompe a compilação corrente após um erro já informado. Dentro do driver
+ * volta ao início da compilação do arquivo; fora dele encerra o programa.
+ */
+_Noreturn void compile_abort(void)
+{
+    if (current_context)
+        longjmp(current_context->abort, 1);
+    exit(EXIT_FAILURE);
+}
+
+/**
+ * Escreve uma mensagem de erro de compilação (sem o '\n' final) na saída de
+ * erros. Dentro do driver a mensagem é precedida do nome do arquivo, já que as
+ * mensagens de todas as threads se misturam, e sai numa única escrita.
+ */
+void compile_error(const char *format, ...)
+{
+    char message[1024];
+    va_list args;
+
+    va_start(args, format);
+    vsnprintf(message, sizeof(message), format, args);
+    va_end(args);
+    if (current_context)
+        fprintf(stderr, "%s: %s\n", current_context->source, message);
+    else
+        fprintf(stderr, "%s\n", message);
+}
+
+/**
+ * Compila um arquivo na thread corrente, do carregamento do fonte à escrita do
+ * código gerado, e devolve o estado da thread ao inicial.
+ */
+static void compile(CONTEXT *ctx)
+{
+    FILE *in = fopen(ctx->source, "r");
+    if (!in)
+    {
+        fprintf(stderr, "%s: %s\n", ctx->source, strerror(errno));
+        ctx->status = COMPILE_IOERROR;
+        return;
+    }
+
+    lexer_file(&lexer, in, &identifiers);
+    fclose(in);
+
+    CACHE procs;
+    if (ctx->cache)
+    {
+        cache_open(&procs, ctx->source);
+        cache = &procs;
+    }
+
+    current_context = ctx;
+    if (setjmp(ctx->abort) == 0)
+    {
+        tokenize(&tokens, &lexer);
+        NODE *program = mypas();
+        typecheck(program);
+        codegen(program);
+        ctx->instructions = codesize;
+        ctx->status = COMPILE_OK;
+        if (cache)
+            cache_commit(cache, program);
+
+        if (ctx->output)
+        {
+            FILE *out = fopen(ctx->output, "w");
+            if (out)
+            {
+                codegen_write(out);
+                fclose(out);
+            }
+            else
+            {
+                fprintf(stderr, "%s: %s\n", ctx->output, strerror(errno));
+                ctx->status = COMPILE_IOERROR;
+            }
+        }
+    }
+    else
+    {
+        ctx->status = COMPILE_ERROR;
+    }
+    current_context = NULL;
+
+    if (cache)
+    {
+        cache_free(cache);
+        cache = NULL;
+    }
+    arena_free(&ast_arena);
+    symtab_reset();
+    intern_free(&identifiers);
+    tokens_free(&tokens);
+    lexer_free(&lexer);
+}
+
+/**
+ * Retira a próxima compilação da própria fila ou, se ela estiver vazia, rouba
+ * uma das outras filas. Retorna -1 quando não há mais trabalho; como nenhuma
+ * compilação gera outras, filas vazias continuam vazias.
+ */
+static int next_job(WORKER *w)
+{
+    DEQUE *own = &w->deques[w->self];
+    int job = -1;
+
+    pthread_mutex_lock(&own->lock);
+    if (own->top < own->bottom)
+        job = own->jobs[--own->bottom];
+    pthread_mutex_unlock(&own->lock);
+
+    for (int i = 1; job < 0 && i < w->nthreads; i++)
+    {
+        DEQUE *victim = &w->deques[(w->self + i) % w->nthreads];
+        pthread_mutex_lock(&victim->lock);
+        if (victim->top < victim->bottom)
+            job = victim->jobs[victim->top++];
+        pthread_mutex_unlock(&victim->lock);
+    }
+    return job;
+}
+
+/**
+ * Laço de uma thread trabalhadora.
+ */
+static void *worker(void *arg)
+{
+    WORKER *w = arg;
+    int job;
+
+    while ((job = next_job(w)) >= 0)
+        compile(&w->jobs[job]);
+
+    codegen_free();
+    return NULL;
+}
+
+/**
+ * Compila `njobs` arquivos com até `nthreads` threads. Os resultados ficam em
+ * cada CONTEXT; retorna o número de compilações que falharam.
+ */
+int compile_files(CONTEXT *jobs, int njobs, int nthreads)
+{
+    if (nthreads > njobs)
+        nthreads = njobs;
+    if (nthreads < 1)
+        nthreads = 1;
+
+    DEQUE *deques = calloc(nthreads, sizeof(DEQUE));
+    WORKER *workers = calloc(nthreads, sizeof(WORKER));
+    pthread_t *threads = calloc(nthreads, sizeof(pthread_t));
+    int *slots = malloc(njobs * sizeof(int));
+    if (!deques || !workers || !threads || !slots)
+    {
+        fprintf(stderr, "Erro: memória insuficiente.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    // Distribui os arquivos entre as filas em rodízio; cada fila ocupa um
+    // trecho contíguo de `slots`
+    int start = 0;
+    for (int t = 0; t < nthreads; t++)
+    {
+        DEQUE *d = &deques[t];
+        pthread_mutex_init(&d->lock, NULL);
+        d->jobs = slots + start;
+        d->top = d->bottom = 0;
+        for (int j = t; j < njobs; j += nthreads)
+            d->jobs[d->bottom++] = j;
+        start += d->bottom;
+    }
+
+    // A thread principal também trabalha, com a fila 0
+    for (int t = 0; t < nthreads; t++)
+    {
+        workers[t] = (WORKER){t, nthreads, deques, jobs};
+        if (t > 0 && pthread_create(&threads[t], NULL, worker, &workers[t]) != 0)
+        {
+            fprintf(stderr, "Erro: não foi possível criar as threads de compilação.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    worker(&workers[0]);
+    for (int t = 1; t < nthreads; t++)
+        pthread_join(threads[t], NULL);
+
+    int failed = 0;
+    for (int j = 0; j < njobs; j++)
+        failed += jobs[j].status != COMPILE_OK;
+
+    for (int t = 0; t < nthreads; t++)
+        pthread_mutex_destroy(&deques[t].lock);
+    free(slots);
+    free(threads);
+    free(workers);
+    free(deques);
+    return failed;
+}
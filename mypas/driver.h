@@ -0,0 +1,36 @@
+// driver.h
+#ifndef DRIVER_H
+#define DRIVER_H
+
+#include <setjmp.h>
+
+// Compilação de um arquivo pelo driver de vários arquivos. O estado do
+// compilador (lexer, tabela de símbolos, árvore e código gerado) é local a
+// cada thread, de modo que cada thread compila um arquivo por vez do início
+// ao fim; o contexto guarda o que é próprio da compilação e o ponto de retorno
+// dos erros fatais.
+typedef struct _context_
+{
+    const char *source; // Arquivo fonte
+    const char *output; // Arquivo para o código gerado (NULL se não houver)
+    int cache;          // 1 para usar o cache incremental (--cache)
+    int status;         // COMPILE_OK, COMPILE_ERROR ou COMPILE_IOERROR
+    int instructions;   // Número de instruções geradas
+    jmp_buf abort;      // Retorno de compile_abort
+} CONTEXT;
+
+enum
+{
+    COMPILE_OK,
+    COMPILE_ERROR,   // Erro léxico, sintático ou semântico
+    COMPILE_IOERROR, // Falha ao ler o fonte ou escrever a saída
+};
+
+// Compilação em andamento na thread corrente (NULL fora do driver)
+extern _Thread_local CONTEXT *current_context;
+
+_Noreturn void compile_abort(void);
+void compile_error(const char *format, ...);
+int compile_files(CONTEXT *jobs, int njobs, int nthreads);
+
+#endif
@@ -0,0 +1,95 @@
+// intern.c
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "intern.h"
+
+_Thread_local INTERN identifiers;
+
+/**
+ * Calcula o hash (FNV-1a) de um trecho de texto.
+ */
+static unsigned intern_hash(const char *text, int length)
+{
+    unsigned h = 2166136261u;
+    for (int i = 0; i < length; i++)
+    {
+        h ^= (unsigned char)text[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+/**
+ * Aumenta os vetores da tabela e reconstrói o índice hash com o dobro de
+ * posições, mantendo o índice no máximo meio cheio.
+ */
+static void intern_grow(INTERN *table)
+{
+    int capacity = table->capacity ? 2 * table->capacity : 256;
+    const char **names = realloc(table->names, capacity * sizeof(*names));
+    int *lengths = realloc(table->lengths, capacity * sizeof(*lengths));
+    int *hash = calloc(2 * capacity, sizeof(*hash));
+    if (!names || !lengths || !hash)
+    {
+        fprintf(stderr, "Erro: memória insuficiente.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for (int id = 0; id < table->count; id++)
+    {
+        unsigned h = intern_hash(names[id], lengths[id]) & (2 * capacity - 1);
+        while (hash[h])
+            h = (h + 1) & (2 * capacity - 1);
+        hash[h] = id + 1;
+    }
+
+    free(table->hash);
+    table->names = names;
+    table->lengths = lengths;
+    table->hash = hash;
+    table->capacity = capacity;
+    table->hashsize = 2 * capacity;
+}
+
+/**
+ * Retorna o id do identificador `text` de comprimento `length`, que pode ser um
+ * trecho do fonte sem '\0' no fim. O nome só é copiado na primeira ocorrência.
+ */
+int intern(INTERN *table, const char *text, int length)
+{
+    if (table->count == table->capacity)
+        intern_grow(table);
+
+    unsigned mask = table->hashsize - 1;
+    unsigned h = intern_hash(text, length) & mask;
+
+    // Sondagem linear até achar o nome ou uma posição vazia
+    for (; table->hash[h]; h = (h + 1) & mask)
+    {
+        int id = table->hash[h] - 1;
+        if (table->lengths[id] == length && memcmp(table->names[id], text, length) == 0)
+            return id;
+    }
+
+    char *copy = arena_alloc(&table->arena, length + 1); // Zerada: já termina em '\0'
+    memcpy(copy, text, length);
+
+    int id = table->count++;
+    table->names[id] = copy;
+    table->lengths[id] = length;
+    table->hash[h] = id + 1;
+    return id;
+}
+
+/**
+ * Libera a tabela inteira; os nomes obtidos dela deixam de ser válidos.
+ */
+void intern_free(INTERN *table)
+{
+    arena_free(&table->arena);
+    free(table->names);
+    free(table->lengths);
+    free(table->hash);
+    memset(table, 0, sizeof(*table));
+}
@@ -0,0 +1,30 @@
+// intern.h
+#ifndef INTERN_H
+#define INTERN_H
+
+#include "arena.h"
+
+// Tabela de nomes internados: cada identificador distinto recebe um número
+// (id) e uma única cópia terminada por '\0', guardada na arena da tabela.
+// Dois identificadores são iguais se, e somente se, têm o mesmo id.
+typedef struct
+{
+    ARENA arena;        // Cópias dos nomes
+    const char **names; // Nome de cada id
+    int *lengths;       // Comprimento de cada nome
+    int *hash;          // Índice hash aberto: id + 1 (0 = posição vazia)
+    int count;          // Número de ids atribuídos
+    int capacity;       // Capacidade de names e lengths
+    int hashsize;       // Número de posições do índice (potência de 2)
+} INTERN;
+
+// Identificadores do programa em compilação na thread corrente
+extern _Thread_local INTERN identifiers;
+
+int intern(INTERN *table, const char *text, int length);
+void intern_free(INTERN *table);
+
+// Nome (terminado por '\0') de um id
+#define intern_name(table, id) ((table)->names[id])
+
+#endif
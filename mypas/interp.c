@@ -0,0 +1,323 @@
+// interp.c
+#include <stdio.h>
+#include <stdlib.h>
+#include "codegen.h"
+#include "interp.h"
+
+// Instrução traduzida: o código de operação é substituído pelo endereço do
+// trecho do interpretador que a executa (despacho por código encadeado)
+typedef struct _tinstr_
+{
+    const void *label;
+    int op;
+    int level;
+    long arg;
+} TINSTR;
+
+// Pilha de execução: registros de ativação e valores temporários.
+// Chamadas apenas movem os índices sp e bp; nada é alocado por chamada.
+static CELL stack[STACKSIZE];
+
+// Operação aritmética sobre os dois valores do topo, inteira ou real
+#define ARITH(field, opr)                         \
+    sp--;                                         \
+    s[sp].field = s[sp].field opr s[sp + 1].field;
+
+// Comparação dos dois valores do topo; o resultado é o inteiro 1 ou 0
+#define COMPARE(field, opr)                       \
+    sp--;                                         \
+    s[sp].i = s[sp].field opr s[sp + 1].field;
+
+// Índice do registro de ativação `l` níveis léxicos acima do atual
+#define BASE(l, b)                  \
+    do                              \
+    {                               \
+        b = bp;                     \
+        for (int k = (l); k > 0; k--) \
+            b = s[b].i;             \
+    } while (0)
+
+// Despacho: com GCC/Clang cada instrução salta diretamente para a próxima
+// (computed goto); nos demais compiladores usa-se um switch
+#ifdef __GNUC__
+#define CASE(op) L_##op:
+#define NEXT goto *pc->label
+#else
+#define CASE(op) case op:
+#define NEXT continue
+#endif
+
+/**
+ * Interrompe a execução com uma mensagem de erro.
+ */
+static int runtime_error(const char *message, long at)
+{
+    fflush(stdout);
+    fprintf(stderr, "Erro de execução na instrução %ld: %s.\n", at, message);
+    return EXIT_FAILURE;
+}
+
+/**
+ * Executa o programa gerado em code[].
+ * As instruções são primeiro traduzidas para código encadeado e depois
+ * executadas a partir da instrução 0. Retorna 0 em caso de sucesso.
+ */
+int interpret(void)
+{
+#ifdef __GNUC__
+    // Endereços dos trechos do interpretador, na ordem do enum de codegen.h
+    static const void *labels[] = {
+        &&L_OP_LIT, &&L_OP_LOD, &&L_OP_STO, &&L_OP_LDA, &&L_OP_LDI, &&L_OP_STI, &&L_OP_INT,
+        &&L_OP_ADD, &&L_OP_SUB, &&L_OP_MUL, &&L_OP_IDIV, &&L_OP_MOD,
+        &&L_OP_RADD, &&L_OP_RSUB, &&L_OP_RMUL, &&L_OP_RDIV, &&L_OP_FLT,
+        &&L_OP_AND, &&L_OP_OR, &&L_OP_NOT,
+        &&L_OP_EQL, &&L_OP_NEQ, &&L_OP_LSS, &&L_OP_LEQ, &&L_OP_GTR, &&L_OP_GEQ,
+        &&L_OP_REQL, &&L_OP_RNEQ, &&L_OP_RLSS, &&L_OP_RLEQ, &&L_OP_RGTR, &&L_OP_RGEQ,
+        &&L_OP_JMP, &&L_OP_JPC, &&L_OP_CAL, &&L_OP_RET, &&L_OP_WRT, &&L_OP_RWRT, &&L_OP_WRL, &&L_OP_HLT};
+#endif
+
+    // Tradução do programa para código encadeado
+    TINSTR *program = malloc(codesize * sizeof(TINSTR));
+    if (!program)
+    {
+        fprintf(stderr, "Erro: memória insuficiente para o programa.\n");
+        return EXIT_FAILURE;
+    }
+    for (int i = 0; i < codesize; i++)
+    {
+#ifdef __GNUC__
+        program[i].label = labels[code[i].op];
+#endif
+        program[i].op = code[i].op;
+        program[i].level = code[i].level;
+        program[i].arg = code[i].arg;
+    }
+
+    CELL *s = stack;
+    long sp = -1; // Topo da pilha
+    long bp = 0;  // Base do registro de ativação corrente
+    long b;
+    int status = 0;
+    const TINSTR *pc = program;
+
+#ifdef __GNUC__
+    NEXT;
+#else
+    for (;;)
+        switch (pc->op)
+        {
+#endif
+
+    CASE(OP_LIT)
+        s[++sp].i = pc->arg;
+        pc++;
+        NEXT;
+    CASE(OP_LOD)
+        BASE(pc->level, b);
+        s[++sp] = s[b + pc->arg];
+        pc++;
+        NEXT;
+    CASE(OP_STO)
+        BASE(pc->level, b);
+        s[b + pc->arg] = s[sp--];
+        pc++;
+        NEXT;
+    CASE(OP_LDA)
+        BASE(pc->level, b);
+        s[++sp].i = b + pc->arg;
+        pc++;
+        NEXT;
+    CASE(OP_LDI)
+        s[sp] = s[s[sp].i];
+        pc++;
+        NEXT;
+    CASE(OP_STI)
+        s[s[sp - 1].i] = s[sp];
+        sp -= 2;
+        pc++;
+        NEXT;
+    CASE(OP_INT)
+        // Na entrada de um bloco, level é o espaço dos temporários das expressões
+        // do bloco, de modo que as instruções do corpo não precisam verificar a pilha
+        if (sp + pc->arg + pc->level >= STACKSIZE)
+        {
+            status = runtime_error("estouro da pilha", pc - program);
+            goto done;
+        }
+        for (long k = 1; k <= pc->arg; k++) // Zera as células reservadas (0 e 0.0)
+            s[sp + k].i = 0;
+        sp += pc->arg;
+        pc++;
+        NEXT;
+    CASE(OP_ADD)
+        ARITH(i, +);
+        pc++;
+        NEXT;
+    CASE(OP_SUB)
+        ARITH(i, -);
+        pc++;
+        NEXT;
+    CASE(OP_MUL)
+        ARITH(i, *);
+        pc++;
+        NEXT;
+    CASE(OP_IDIV)
+        sp--;
+        if (s[sp + 1].i == 0)
+        {
+            status = runtime_error("divisão por zero", pc - program);
+            goto done;
+        }
+        s[sp].i = s[sp].i / s[sp + 1].i;
+        pc++;
+        NEXT;
+    CASE(OP_MOD)
+        sp--;
+        if (s[sp + 1].i == 0)
+        {
+            status = runtime_error("divisão por zero", pc - program);
+            goto done;
+        }
+        s[sp].i = s[sp].i % s[sp + 1].i;
+        pc++;
+        NEXT;
+    CASE(OP_RADD)
+        ARITH(r, +);
+        pc++;
+        NEXT;
+    CASE(OP_RSUB)
+        ARITH(r, -);
+        pc++;
+        NEXT;
+    CASE(OP_RMUL)
+        ARITH(r, *);
+        pc++;
+        NEXT;
+    CASE(OP_RDIV)
+        ARITH(r, /);
+        pc++;
+        NEXT;
+    CASE(OP_FLT)
+        s[sp].r = (double)s[sp].i;
+        pc++;
+        NEXT;
+    CASE(OP_AND)
+        sp--;
+        s[sp].i = s[sp].i & s[sp + 1].i; // Booleanos são sempre 0 ou 1
+        pc++;
+        NEXT;
+    CASE(OP_OR)
+        sp--;
+        s[sp].i = s[sp].i | s[sp + 1].i;
+        pc++;
+        NEXT;
+    CASE(OP_NOT)
+        s[sp].i = !s[sp].i;
+        pc++;
+        NEXT;
+    CASE(OP_EQL)
+        COMPARE(i, ==);
+        pc++;
+        NEXT;
+    CASE(OP_NEQ)
+        COMPARE(i, !=);
+        pc++;
+        NEXT;
+    CASE(OP_LSS)
+        COMPARE(i, <);
+        pc++;
+        NEXT;
+    CASE(OP_LEQ)
+        COMPARE(i, <=);
+        pc++;
+        NEXT;
+    CASE(OP_GTR)
+        COMPARE(i, >);
+        pc++;
+        NEXT;
+    CASE(OP_GEQ)
+        COMPARE(i, >=);
+        pc++;
+        NEXT;
+    CASE(OP_REQL)
+        COMPARE(r, ==);
+        pc++;
+        NEXT;
+    CASE(OP_RNEQ)
+        COMPARE(r, !=);
+        pc++;
+        NEXT;
+    CASE(OP_RLSS)
+        COMPARE(r, <);
+        pc++;
+        NEXT;
+    CASE(OP_RLEQ)
+        COMPARE(r, <=);
+        pc++;
+        NEXT;
+    CASE(OP_RGTR)
+        COMPARE(r, >);
+        pc++;
+        NEXT;
+    CASE(OP_RGEQ)
+        COMPARE(r, >=);
+        pc++;
+        NEXT;
+    CASE(OP_JMP)
+        pc = program + pc->arg;
+        NEXT;
+    CASE(OP_JPC)
+        if (s[sp].i)
+            pc++;
+        else
+            pc = program + pc->arg;
+        sp--;
+        NEXT;
+    CASE(OP_CAL)
+        if (sp + FRAME_HEADER >= STACKSIZE)
+        {
+            status = runtime_error("estouro da pilha", pc - program);
+            goto done;
+        }
+        BASE(pc->level, b);
+        s[sp + 1].i = b;                     // Elo estático
+        s[sp + 2].i = bp;                    // Elo dinâmico
+        s[sp + 3].i = pc - program + 1;      // Endereço de retorno
+        bp = sp + 1;
+        sp += FRAME_HEADER;
+        pc = program + pc->arg;
+        NEXT;
+    CASE(OP_RET)
+        sp = bp - 1 - pc->arg;
+        pc = program + s[bp + 2].i;
+        bp = s[bp + 1].i;
+        NEXT;
+    CASE(OP_WRT)
+        if (pc->arg)
+            putchar(' ');
+        printf("%ld", s[sp].i);
+        sp--;
+        pc++;
+        NEXT;
+    CASE(OP_RWRT)
+        if (pc->arg)
+            putchar(' ');
+        printf("%g", s[sp].r);
+        sp--;
+        pc++;
+        NEXT;
+    CASE(OP_WRL)
+        putchar('\n');
+        pc++;
+        NEXT;
+    CASE(OP_HLT)
+        goto done;
+
+#ifndef __GNUC__
+        }
+#endif
+
+done:
+    free(program);
+    return status;
+}
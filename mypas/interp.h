@@ -0,0 +1,19 @@
+// interp.h
+#ifndef INTERP_H
+#define INTERP_H
+
+// Número de células da pilha de execução
+#define STACKSIZE (1 << 22)
+
+// Célula da pilha de execução. O tipo do valor não é guardado: a verificação
+// de tipos garante que cada instrução recebe os tipos que espera (inteiros,
+// booleanos como 0 ou 1, endereços ou reais)
+typedef union _cell_
+{
+    long i;
+    double r;
+} CELL;
+
+int interpret(void);
+
+#endif
@@ -2,6 +2,7 @@
 #include "keywords.h"
 #include "lexer.h"
 
+// Palavras-chave indexadas por (token - BEGIN)
 char *keywords[] = {
     "begin",
     "in",
@@ -29,11 +30,58 @@ char *keywords[] = {
     "do",
     "end"};
 
-int iskeyword(char *identifier)
+// Hash perfeito das palavras-chave: combina o primeiro caractere, o último e o
+// comprimento. Os coeficientes foram escolhidos por busca exaustiva para que as
+// 25 palavras de keywords[] caiam em posições distintas da tabela abaixo; ao
+// incluir uma nova palavra-chave é preciso refazer a busca e a tabela.
+#define KEYWORD_HASH(first, last, length) (((first) + 9 * (last) + 10 * (length)) & 63)
+
+// Tabela de tokens indexada pelo hash (0 indica posição vazia)
+static const short keyword_table[64] = {
+    [2] = REPEAT,
+    [3] = AND,
+    [5] = OR,
+    [6] = BOOLEAN,
+    [7] = END,
+    [11] = PROGRAM,
+    [14] = STRING,
+    [15] = MOD,
+    [19] = IF,
+    [20] = FUNCTION,
+    [22] = VAR,
+    [23] = PROCEDURE,
+    [26] = ELSE,
+    [27] = IN,
+    [31] = DO,
+    [32] = NOT,
+    [38] = REAL,
+    [40] = DIV,
+    [45] = DOUBLE,
+    [49] = INTEGER,
+    [50] = BEGIN,
+    [51] = UNTIL,
+    [54] = WHILE,
+    [58] = THEN,
+    [63] = CHARACTER,
+};
+
+/**
+ * Verifica se o identificador de comprimento `length` é uma palavra-chave.
+ * Retorna o token correspondente ou 0; custa um hash e uma única comparação.
+ */
+int iskeyword(const char *identifier, int length)
 {
-    for (int i = BEGIN; i <= END; i++)
-        if (strcmp(keywords[i - BEGIN], identifier) == 0)
-            return i;
+    if (length < 2 || length > 9) // Comprimentos de "in" a "character"
+        return 0;
+
+    int token = keyword_table[KEYWORD_HASH((unsigned char)identifier[0],
+                                           (unsigned char)identifier[length - 1], length)];
+    if (token)
+    {
+        const char *keyword = keywords[token - BEGIN];
+        if (strncmp(keyword, identifier, length) == 0 && keyword[length] == '\0')
+            return token;
+    }
 
     return 0;
-}
\ No newline at end of file
+}
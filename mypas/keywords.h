@@ -1,10 +1,16 @@
 #ifndef KEYWORDS_H
 #define KEYWORDS_H
 
+// Tokens das palavras-chave, na mesma ordem do array keywords[]
 enum
 {
     BEGIN = 2048,
-    END,
+    IN,
+    AND,
+    OR,
+    NOT,
+    MOD,
+    DIV,
     INTEGER,
     REAL,
     DOUBLE,
@@ -21,11 +27,12 @@ enum
     REPEAT,
     UNTIL,
     WHILE,
-    DO
+    DO,
+    END
 };
 
 extern char *keywords[];
 
-int iskeyword(char *identifier);
+int iskeyword(const char *identifier, int length);
 
 #endif
@@ -1,267 +1,471 @@
 #include <ctype.h>  // Inclui funções para classificação de caracteres, como isalpha e isdigit
-#include <stdio.h>  // Inclui funções padrão de I/O, como getc e ungetc
+#include <stdio.h>  // Inclui funções padrão de I/O, como fread
+#include <stdlib.h> // Inclui funções de alocação de memória, como malloc e realloc
 #include "lexer.h"  // Inclui o cabeçalho do lexer com definições e declarações necessárias
+#include "stats.h"  // Inclui as medições do modo --stats
 #include <string.h> // Inclui funções de manipulação de strings, como strcmp e strcpy
+#include <unistd.h>   // Inclui sysconf, para o tamanho da página
+#include <sys/mman.h> // Inclui mmap e madvise
+#include <sys/stat.h> // Inclui fstat
+#if defined(__SSE2__)
+#include <immintrin.h> // Inclui as instruções vetoriais SSE2/AVX2
+#endif
 
-// Array para armazenar o lexema atual com tamanho máximo definido
-char lexeme[MAXIDLEN + 1];
+// Tamanho dos blocos lidos do arquivo fonte de uma só vez
+#define BLOCKSIZE 65536
 
-// Função para verificar se o próximo caractere forma um operador de atribuição ":="
-int isASGN(FILE *tape)
+/**
+ * Mapeia na memória, somente para leitura, o arquivo regular aberto em `tape`.
+ * O mapeamento vai até a página seguinte ao fim do arquivo, que é anônima e
+ * zerada, de modo que o conteúdo sempre termina em '\0'. Retorna NULL para a
+ * entrada padrão, pipes, arquivos vazios ou se o mapeamento falhar.
+ */
+static char *mapfile(FILE *tape, size_t *size, size_t *mapped)
 {
-    if ((lexeme[0] = getc(tape)) == ':') {
-        if ((lexeme[1] = getc(tape)) == '=') {
-            lexeme[2] = 0; // Termina a string do lexema
-            return ASGN; // Retorna o token de atribuição
-        }
-        ungetc(lexeme[1], tape); // Coloca de volta o último caractere lido
+    struct stat st;
+    int fd = fileno(tape);
+
+    if (fstat(fd, &st) < 0 || !S_ISREG(st.st_mode) || st.st_size == 0 || ftello(tape) != 0)
+        return NULL;
+
+    size_t page = sysconf(_SC_PAGESIZE);
+    size_t length = ((size_t)st.st_size / page + 1) * page;
+    char *base = mmap(NULL, length, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED)
+        return NULL;
+    if (mmap(base, st.st_size, PROT_READ, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED)
+    {
+        munmap(base, length);
+        return NULL;
     }
-    ungetc(lexeme[0], tape); // Coloca de volta o caractere lido anteriormente
-    return 0; // Não reconhecido
+    madvise(base, st.st_size, MADV_SEQUENTIAL); // O lexer lê o arquivo uma vez, do início ao fim
+
+    *size = st.st_size;
+    *mapped = length;
+    return base;
 }
 
-// Função para verificar e processar identificadores (IDs)
-int isID(FILE *tape)
+/**
+ * Prepara a análise de um arquivo. Arquivos regulares são mapeados na memória,
+ * sem cópia; a entrada padrão e pipes são lidos para a memória em blocos
+ * grandes com fread. Em ambos os casos a análise léxica percorre o conteúdo
+ * com um ponteiro, e o arquivo pode ser fechado logo em seguida.
+ */
+void lexer_file(LEXER *lex, FILE *tape, INTERN *names)
 {
-    lexeme[0] = getc(tape); // Obtém o primeiro caractere
+    size_t size = 0, capacity = BLOCKSIZE, mapped;
+    size_t n;
 
-    if (isalpha(lexeme[0])) // Verifica se é uma letra
+    char *map = mapfile(tape, &size, &mapped);
+    if (map)
     {
-        int i = 1;
-        // Continua lendo caracteres alfanuméricos
-        while (isalnum(lexeme[i] = getc(tape)))
-            i++;
+        lexer_range(lex, map, size, names);
+        lex->buffer = map;
+        lex->mapped = mapped;
+        return;
+    }
 
-        ungetc(lexeme[i], tape); // Retorna o caractere não alfanumérico ao stream
-        lexeme[i] = '\0';        // Termina a string
+    char *buffer = malloc(capacity + 1);
+    if (!buffer)
+    {
+        fprintf(stderr, "Erro: memória insuficiente para o arquivo fonte.\n");
+        exit(EXIT_FAILURE);
+    }
 
-        return ID; // Retorna o token ID
+    // Lê blocos até o fim do arquivo, dobrando o buffer quando ele enche
+    while ((n = fread(buffer + size, 1, capacity - size, tape)) > 0)
+    {
+        size += n;
+        if (size == capacity)
+        {
+            capacity *= 2;
+            char *grown = realloc(buffer, capacity + 1);
+            if (!grown)
+            {
+                fprintf(stderr, "Erro: memória insuficiente para o arquivo fonte.\n");
+                exit(EXIT_FAILURE);
+            }
+            buffer = grown;
+        }
     }
 
-    ungetc(lexeme[0], tape); // Retorna o caractere ao stream se não for letra
-    lexeme[0] = '\0';        // Limpa o lexeme
+    buffer[size] = '\0'; // Sentinela de fim de arquivo
+    lexer_range(lex, buffer, size, names);
+    lex->buffer = buffer;
+}
 
-    return 0; // Retorna 0 indicando que não é um ID
+/**
+ * Prepara a análise de um texto em memória, terminado por '\0'. O texto não é
+ * copiado e deve permanecer válido enquanto os tokens forem usados. Os
+ * identificadores são internados em `names`.
+ */
+void lexer_string(LEXER *lex, const char *text, INTERN *names)
+{
+    lexer_range(lex, text, strlen(text), names);
+}
+
+/**
+ * Prepara a análise dos `length` bytes em `text`, que precisam ser seguidos
+ * de '\0'. O texto não é copiado.
+ */
+void lexer_range(LEXER *lex, const char *text, size_t length, INTERN *names)
+{
+    lex->buffer = NULL;
+    lex->mapped = 0;
+    lex->source = lex->cur = lex->linestart = text;
+    lex->limit = text + length;
+    lex->names = names;
+    lex->line = 1;
+    lex->column = lex->offset = lex->length = 0;
+    lex->id = -1;
 }
 
-// Função para verificar e processar números decimais (DEC)
-int isDEC(FILE *tape)
+/**
+ * Libera o buffer ou o mapeamento de um analisador criado por lexer_file.
+ */
+void lexer_free(LEXER *lex)
 {
-    int head = getc(tape); // Obtém o primeiro caractere
+    if (lex->mapped)
+        munmap(lex->buffer, lex->mapped);
+    else
+        free(lex->buffer);
+    lex->buffer = NULL;
+    lex->mapped = 0;
+    lex->source = lex->cur = lex->limit = lex->linestart = NULL;
+}
+
+// Avança sobre uma quebra de linha, contando a linha
+static inline void newline(LEXER *lex, const char *cur)
+{
+    lex->line++;
+    lex->linestart = cur + 1;
+}
+
+/*
+ * Varredura vetorial de espaços e comentários: blocos de VECSIZE bytes são
+ * comparados de uma vez com AVX2 (32 bytes) ou SSE2 (16 bytes), quando o
+ * compilador os habilita. Cada comparação produz uma máscara com um bit por
+ * byte do bloco, e as quebras de linha do bloco são contadas com popcount.
+ * Só são lidos blocos que cabem inteiros antes de `limit`; o restante da
+ * entrada é percorrido byte a byte.
+ */
+#if defined(__AVX2__)
+#define VECSIZE 32
+#define VECALL 0xFFFFFFFFu // Máscara com todos os bytes do bloco
+typedef __m256i VEC;
+#define vload(p) _mm256_loadu_si256((const __m256i *)(p))
+#define vbyte(c) _mm256_set1_epi8(c)
+#define veq(a, b) _mm256_cmpeq_epi8(a, b)
+#define vor(a, b) _mm256_or_si256(a, b)
+#define vsub(a, b) _mm256_sub_epi8(a, b)
+#define vmin(a, b) _mm256_min_epu8(a, b)
+#define vmask(v) ((unsigned)_mm256_movemask_epi8(v))
+#elif defined(__SSE2__)
+#define VECSIZE 16
+#define VECALL 0xFFFFu
+typedef __m128i VEC;
+#define vload(p) _mm_loadu_si128((const __m128i *)(p))
+#define vbyte(c) _mm_set1_epi8(c)
+#define veq(a, b) _mm_cmpeq_epi8(a, b)
+#define vor(a, b) _mm_or_si128(a, b)
+#define vsub(a, b) _mm_sub_epi8(a, b)
+#define vmin(a, b) _mm_min_epu8(a, b)
+#define vmask(v) ((unsigned)_mm_movemask_epi8(v))
+#endif
+
+#ifdef VECSIZE
+// Máscara dos espaços em branco de um bloco: ' ' e '\t' a '\r', como isspace
+static inline unsigned spacemask(VEC v)
+{
+    VEC ctl = vsub(v, vbyte('\t')); // '\t'..'\r' viram 0..4
+    return vmask(vor(veq(v, vbyte(' ')), veq(vmin(ctl, vbyte(4)), ctl)));
+}
 
-    if (isdigit(head)) // Verifica se é um dígito
+// Conta as quebras de linha marcadas em `nl` (bit i = block[i]), atualizando
+// o início da linha corrente para depois da última delas
+static inline void newlines(LEXER *lex, const char *block, unsigned nl)
+{
+    if (nl)
     {
-        if (head == '0')
-        {
-            return DEC; // Retorna DEC para número começando com 0
-        }
-        // Continua lendo dígitos
-        while (isdigit(head = getc(tape)))
-            ;
-        ungetc(head, tape); // Retorna o caractere não dígito ao stream
-        return DEC;         // Retorna DEC para número válido
+        lex->line += __builtin_popcount(nl);
+        lex->linestart = block + (31 - __builtin_clz(nl)) + 1;
     }
-    ungetc(head, tape); // Retorna o caractere ao stream se não for dígito
-    return 0;           // Retorna 0 indicando que não é um DEC
 }
+#endif
+
+// Função para verificar e processar identificadores (IDs) e palavras-chave
+static int isID(LEXER *lex)
+{
+    const char *cur = lex->cur;
 
-// Variável global para rastrear o número da linha atual
-int linenum = 1;
+    if (isalpha((unsigned char)*cur)) // Verifica se é uma letra
+    {
+        const char *start = cur;
+        // Continua lendo caracteres alfanuméricos
+        while (isalnum((unsigned char)*cur))
+            cur++;
+        lex->cur = cur;
 
-// Função para ignorar espaços em branco e comentários
-void skipspaces(FILE *tape)
+        // Verifica se o identificador corresponde a uma palavra-chave
+        int len = cur - start;
+        int token = iskeyword(start, len);
+        if (token)
+            return token;
+
+        // Interna o identificador, sem copiá-lo se o nome já é conhecido
+        lex->id = intern(lex->names, start, len);
+        return ID; // Retorna o token ID
+    }
+
+    return 0; // Retorna 0 indicando que não é um ID
+}
+
+// Função para ignorar comentários com base no caractere de término
+static void skipcomments(LEXER *lex, char end_char)
 {
-    int head;
+    const char *cur = lex->cur, *limit = lex->limit;
 
-    while ((head = getc(tape)) != EOF)
+    if (end_char == '}')
     {
-        if (isspace(head)) // Verifica se é um espaço em branco
-        {
-            if (head == '\n')
-                linenum++; // Incrementa o contador de linhas em nova linha
-        }
-        else if (head == '{') // Início de comentário do tipo { }
+        // Comentário do tipo { }
+#ifdef VECSIZE
+        while (cur + VECSIZE <= limit)
         {
-            skipcomments(tape, '}'); // Ignora até '}'
+            VEC v = vload(cur);
+            unsigned end = vmask(veq(v, vbyte('}')));
+            unsigned nl = vmask(veq(v, vbyte('\n')));
+            if (end)
+            {
+                int n = __builtin_ctz(end);
+                newlines(lex, cur, nl & ((1u << n) - 1)); // Apenas as linhas antes do '}'
+                lex->cur = cur + n + 1;
+                return;
+            }
+            newlines(lex, cur, nl);
+            cur += VECSIZE;
         }
-        else if (head == '(') // Possível início de comentário (* *)
+#endif
+        while (cur < limit)
         {
-            int next_char = getc(tape);
-            if (next_char == '*')
+            if (*cur == '}')
             {
-                skipcomments(tape, '*'); // Ignora até '*)'
+                cur++;
+                break; // Fim do comentário
             }
-            else
+            if (*cur == '\n')
+                newline(lex, cur); // Incrementa o contador de linhas
+            cur++;
+        }
+    }
+    else if (end_char == '*')
+    {
+        // Comentário do tipo (* *)
+#ifdef VECSIZE
+        while (cur + VECSIZE + 1 <= limit)
+        {
+            // Um '*' cujo byte seguinte é ')': compara o bloco deslocado de um byte
+            VEC v = vload(cur);
+            unsigned end = vmask(veq(v, vbyte('*'))) & vmask(veq(vload(cur + 1), vbyte(')')));
+            unsigned nl = vmask(veq(v, vbyte('\n')));
+            if (end)
             {
-                ungetc(next_char, tape); // Retorna o caractere se não for '*'
-                ungetc(head, tape);      // Retorna '(' ao stream
-                break;                   // Sai do loop
+                int n = __builtin_ctz(end);
+                newlines(lex, cur, nl & ((1u << n) - 1));
+                lex->cur = cur + n + 2;
+                return;
             }
+            newlines(lex, cur, nl);
+            cur += VECSIZE;
         }
-        else
+#endif
+        while (cur < limit)
         {
-            ungetc(head, tape); // Retorna o caractere não tratado ao stream
-            break;              // Sai do loop
+            if (cur[0] == '*' && cur[1] == ')')
+            {
+                cur += 2;
+                break; // Fim do comentário
+            }
+            if (*cur == '\n')
+                newline(lex, cur); // Incrementa o contador de linhas
+            cur++;
         }
     }
+    lex->cur = cur;
 }
 
-// Função para ignorar comentários com base no caractere de término
-void skipcomments(FILE *tape, char end_char)
+// Avança sobre uma sequência de espaços em branco, contando as linhas
+static void skipblanks(LEXER *lex)
 {
-    int head;
+    const char *cur = lex->cur, *limit = lex->limit;
 
-    if (end_char == '}')
+#ifdef VECSIZE
+    // Entre tokens costuma haver no máximo um espaço, resolvido sem carregar um bloco
+    if (cur + 1 < limit && !isspace((unsigned char)cur[cur[0] == ' ']))
     {
-        // Comentário do tipo { }
-        while ((head = getc(tape)) != EOF)
+        lex->cur = cur + (cur[0] == ' ');
+        return;
+    }
+    while (cur + VECSIZE <= limit)
+    {
+        VEC v = vload(cur);
+        unsigned stop = ~spacemask(v) & VECALL; // Bytes que encerram a sequência
+        unsigned nl = vmask(veq(v, vbyte('\n')));
+        if (stop)
         {
-            if (head == '}')
-                break; // Fim do comentário
-            if (head == '\n')
-                linenum++; // Incrementa o contador de linhas
+            int n = __builtin_ctz(stop);
+            newlines(lex, cur, nl & ((1u << n) - 1));
+            lex->cur = cur + n;
+            return;
         }
+        newlines(lex, cur, nl);
+        cur += VECSIZE;
     }
-    else if (end_char == '*')
+#endif
+    while (cur < limit && isspace((unsigned char)*cur)) // Verifica se é um espaço em branco
     {
-        // Comentário do tipo (* *)
-        int prev_char = 0;
-        while ((head = getc(tape)) != EOF)
+        if (*cur == '\n')
+            newline(lex, cur); // Incrementa o contador de linhas em nova linha
+        cur++;
+    }
+    lex->cur = cur;
+}
+
+// Função para ignorar espaços em branco e comentários
+static void skipspaces(LEXER *lex)
+{
+    while (lex->cur < lex->limit)
+    {
+        skipblanks(lex);
+        const char *cur = lex->cur;
+        if (cur >= lex->limit)
+        {
+            break; // Fim da entrada
+        }
+        else if (*cur == '{') // Início de comentário do tipo { }
+        {
+            lex->cur = cur + 1;
+            skipcomments(lex, '}'); // Ignora até '}'
+        }
+        else if (cur[0] == '(' && cur[1] == '*') // Início de comentário (* *)
         {
-            if (head == '\n')
-                linenum++; // Incrementa o contador de linhas
-            if (prev_char == '*' && head == ')')
-                break;        // Fim do comentário
-            prev_char = head; // Atualiza o caractere anterior
+            lex->cur = cur + 2;
+            skipcomments(lex, '*'); // Ignora até '*)'
         }
+        else
+        {
+            break; // Sai do loop no primeiro caractere significativo
+        }
+    }
+}
+
+// Função para processar números em diferentes bases (decimal, octal, hexadecimal).
+// Retorna DEC, OCT ou HEX. Uma constante octal consome também os dígitos 8 e 9,
+// para que o parser a converta inteira e informe o dígito inválido.
+static int isNumber(LEXER *lex)
+{
+    const char *cur = lex->cur;
+    int token = DEC; // Assume base decimal por padrão
+
+    if (cur[0] == '0' && (cur[1] == 'x' || cur[1] == 'X')) // Verifica se é hexadecimal
+    {
+        token = HEX;
+        cur += 2; // Consome o '0x' ou '0X'
+    }
+    else if (cur[0] == '0' && isdigit((unsigned char)cur[1])) // Zero à esquerda: octal
+    {
+        token = OCT;
+    }
+
+    // Lê os caracteres numéricos de acordo com a base
+    while (isdigit((unsigned char)*cur) || (token == HEX && isxdigit((unsigned char)*cur)))
+    {
+        cur++;
     }
+    lex->cur = cur;
+    return token;
 }
 
-// Função principal do lexer para obter o próximo token do arquivo fonte
-int gettoken(FILE *source)
+// Reconhece o token que começa na posição atual do buffer
+static int matchtoken(LEXER *lex)
 {
-    skipspaces(source);    // Ignora espaços em branco e comentários
-    int c = fgetc(source); // Obtém o próximo caractere
 
-    if (c == EOF)
+    if (lex->cur >= lex->limit)
     {
         return -1; // Retorna -1 para EOF
     }
 
-    if (isalpha(c)) // Verifica se começa com letra (possível ID ou palavra-chave)
+    int token;
+    if ((token = isID(lex))) // Verifica se começa com letra (ID ou palavra-chave)
     {
-        int i = 0;
-        lexeme[i++] = c; // Armazena o primeiro caractere no lexeme
-        // Continua lendo caracteres alfanuméricos até o limite
-        while (isalnum(c = getc(source)) && i < MAXIDLEN)
-        {
-            lexeme[i++] = c;
-        }
-        lexeme[i] = '\0'; // Termina a string
-
-        if (c != EOF)
-            ungetc(c, source); // Retorna o caractere não alfanumérico ao stream
-
-        // Verifica se o lexeme corresponde a uma palavra-chave
-        if (strcmp(lexeme, "program") == 0)
-            return PROGRAM;
-        if (strcmp(lexeme, "var") == 0)
-            return VAR;
-        if (strcmp(lexeme, "procedure") == 0)
-            return PROCEDURE;
-        if (strcmp(lexeme, "function") == 0)
-            return FUNCTION;
-        if (strcmp(lexeme, "integer") == 0)
-            return INTEGER;
-        if (strcmp(lexeme, "real") == 0)
-            return REAL;
-        if (strcmp(lexeme, "double") == 0)
-            return DOUBLE;
-        if (strcmp(lexeme, "boolean") == 0)
-            return BOOLEAN;
-        if (strcmp(lexeme, "if") == 0)
-            return IF;
-        if (strcmp(lexeme, "then") == 0)
-            return THEN;
-        if (strcmp(lexeme, "else") == 0)
-            return ELSE;
-        if (strcmp(lexeme, "begin") == 0)
-            return BEGIN;
-        if (strcmp(lexeme, "end") == 0)
-            return END;
-        if (strcmp(lexeme, "while") == 0)
-            return WHILE;
-        if (strcmp(lexeme, "do") == 0)
-            return DO;
-        if (strcmp(lexeme, "repeat") == 0)
-            return REPEAT; // Reconhece 'repeat'
-        if (strcmp(lexeme, "until") == 0)
-            return UNTIL; // Reconhece 'until'
-
-        return ID; // Retorna ID se não for palavra-chave
+        return token;
     }
-    else if (isdigit(c)) // Verifica se começa com dígito (número)
+    else if (isdigit((unsigned char)*lex->cur)) // Verifica se começa com dígito (número)
     {
-        ungetc(c, source); // Retorna o dígito ao stream
-        isNumber(source);  // Processa o número
-        return DEC;        // Retorna DEC para número válido
+        return isNumber(lex); // Processa o número e retorna a sua base
     }
     else
     {
         // Processa outros símbolos
+        const char *cur = lex->cur;
+        int c = (unsigned char)*cur++;
+        token = c;
         switch (c)
         {
         case '<':
-            if ((c = fgetc(source)) == '=')
-                return RELOP_LE; // Retorna token de operador <=
-            if (c == '>')
-                return RELOP_NE; // Retorna token de operador <>
-            ungetc(c, source);   // Retorna o caractere se não for '=' ou '>'
-            return '<';          // Retorna '<' como token
+            if (*cur == '=')
+            {
+                cur++;
+                token = RELOP_LE; // Token de operador <=
+            }
+            else if (*cur == '>')
+            {
+                cur++;
+                token = RELOP_NE; // Token de operador <>
+            }
+            break;
         case '>':
-            if ((c = fgetc(source)) == '=')
-                return RELOP_GE; // Retorna token de operador >=
-            ungetc(c, source);   // Retorna o caractere se não for '='
-            return '>';          // Retorna '>' como token
+            if (*cur == '=')
+            {
+                cur++;
+                token = RELOP_GE; // Token de operador >=
+            }
+            break;
         case ':':
-            if ((c = fgetc(source)) == '=')
-                return ASGN;   // Retorna token de atribuição ':='
-            ungetc(c, source); // Retorna o caractere se não for '='
-            return ':';        // Retorna ':' como token
-        case '.':
-            return '.'; // Retorna '.' como token
-        default:
-            return c; // Retorna o caractere como token padrão
+            if (*cur == '=')
+            {
+                cur++;
+                token = ASGN; // Token de atribuição ':='
+            }
+            break;
         }
+        lex->cur = cur;
+        return token; // Demais caracteres são o próprio token
     }
 }
 
-// Função para processar números em diferentes bases (decimal, octal, hexadecimal)
-void isNumber(FILE *source)
+// Reconhece o próximo token, registrando a sua posição e o seu comprimento
+static int scantoken(LEXER *lex)
 {
-    int c = getc(source); // Obtém o primeiro caractere do número
-    int num_base = 10;    // Assume base decimal por padrão
+    skipspaces(lex); // Ignora espaços em branco e comentários
+    lex->column = lex->cur - lex->linestart + 1;
+    lex->offset = lex->cur - lex->source;
 
-    if (c == '0') // Verifica se o número começa com '0' (possível octal ou hexadecimal)
-    {
-        c = getc(source);         // Obtém o próximo caractere
-        if (c == 'x' || c == 'X') // Verifica se é hexadecimal
-        {
-            num_base = 16;
-            c = getc(source); // Consome o 'x' ou 'X'
-        }
-        else // Caso contrário, assume octal
-        {
-            num_base = 8;
-            ungetc(c, source); // Retorna o caractere ao stream
-        }
-    }
+    int token = matchtoken(lex);
+    lex->length = lex->cur - lex->source - lex->offset;
+    return token;
+}
 
-    // Lê os caracteres numéricos de acordo com a base
-    while (isdigit(c) || (num_base == 16 && isxdigit(c)))
-    {
-        c = getc(source); // Consome o próximo caractere
-    }
+// Função principal do lexer para obter o próximo token
+int lexer_next(LEXER *lex)
+{
+    if (!stats_enabled)
+        return scantoken(lex);
 
-    ungetc(c, source); // Retorna o caractere não numérico ao stream
+    // Modo --stats: cronometra o lexer e conta os tokens
+    double start = stats_clock();
+    int token = scantoken(lex);
+    stats.lex_time += stats_clock() - start;
+    if (token != -1)
+        stats.tokens++;
+    return token;
 }
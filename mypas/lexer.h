@@ -4,8 +4,7 @@
 
 #include <stdio.h>
 #include "keywords.h"
-
-#define MAXIDLEN 32
+#include "intern.h"
 
 enum
 {
@@ -17,15 +16,36 @@ enum
     RELOP_LE, // "<="
     RELOP_GE, // ">="
     RELOP_NE, // "<>"
-    MOD,      // "mod"
-    DIV,      // "div"
 };
 
-extern int gettoken(FILE *);
-extern int linenum;
-extern char lexeme[];
-extern void isNumber(FILE *);
-void skipspaces(FILE *tape);
-void skipcomments(FILE *tape, char end_char);
+// Estado de uma análise léxica: cada LEXER é independente, de modo que vários
+// programas podem ser analisados ao mesmo tempo, inclusive em threads distintas.
+// A entrada fica inteira em memória (lida ou mapeada), seguida de '\0'. O último token é
+// descrito pela sua posição e comprimento na entrada, sem cópia e sem limite de
+// comprimento; identificadores recebem ainda o id da tabela de nomes.
+typedef struct
+{
+    char *buffer;          // Conteúdo lido ou mapeado por lexer_file (NULL para texto em memória)
+    size_t mapped;         // Tamanho do mapeamento de buffer (0 se lido com fread)
+    const char *source;    // Início da entrada
+    const char *cur;       // Posição atual de leitura
+    const char *limit;     // Fim dos dados
+    const char *linestart; // Início da linha corrente
+    INTERN *names;         // Tabela onde os identificadores são internados
+    int line;              // Linha corrente, para mensagens de erro
+    int column;            // Coluna do início do último token
+    int offset;            // Posição do último token na entrada
+    int length;            // Comprimento do último token
+    int id;                // Id do último identificador (ID)
+} LEXER;
+
+// Texto do último token (não termina em '\0')
+#define lexer_text(lex) ((lex)->source + (lex)->offset)
+
+void lexer_file(LEXER *lex, FILE *tape, INTERN *names);
+void lexer_string(LEXER *lex, const char *text, INTERN *names);
+void lexer_range(LEXER *lex, const char *text, size_t length, INTERN *names);
+void lexer_free(LEXER *lex);
+int lexer_next(LEXER *lex);
 
 #endif
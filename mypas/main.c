@@ -1,38 +1,166 @@
 // main.c
-#include "parser.h" // Inclui o cabeçalho do parser
-#include <stdio.h>	// Inclui a biblioteca padrão de I/O
-#include <stdlib.h> // Inclui a biblioteca padrão
+#include "parser.h"	 // Inclui o cabeçalho do parser
+#include "tokens.h"  // Inclui o vetor de tokens
+#include "check.h"   // Inclui a verificação de tipos
+#include "codegen.h" // Inclui o cabeçalho do gerador de código
+#include "interp.h"  // Inclui o cabeçalho do interpretador
+#include "stats.h"   // Inclui as medições do modo --stats
+#include "driver.h"  // Inclui o driver de vários arquivos
+#include "cache.h"   // Inclui o cache incremental de subprogramas
+#include <stdio.h>	 // Inclui a biblioteca padrão de I/O
+#include <stdlib.h>	 // Inclui a biblioteca padrão
+#include <string.h>	 // Inclui funções de comparação de strings
+#include <unistd.h>	 // Inclui sysconf, para contar os processadores
 
-// Definições de variáveis globais
-int lookahead; // Token atual sendo analisado
-FILE *src;	   // Ponteiro para o arquivo fonte
+// Definições de variáveis globais (uma cópia por thread no driver de vários arquivos)
+_Thread_local int lookahead; // Token atual sendo analisado
+_Thread_local LEXER lexer;   // Analisador léxico do arquivo fonte
 
 int main(int argc, char *argv[]) // Função principal do programa
 {
+	const char *source = NULL; // Nome do arquivo fonte
+	const char *output = NULL; // Arquivo de saída do código gerado (-o)
+	int listing = 0;		   // Escreve o código gerado na saída padrão (-S)
+	int run = 0;			   // Executa o programa após a compilação (-r)
+	int nthreads = 0;		   // Threads do driver de vários arquivos (-j)
+	int use_cache = 0;		   // Cache incremental em <arquivo-fonte>.cache (--cache)
+	int nsources = 0;		   // Número de arquivos fonte
+	CONTEXT *jobs = calloc(argc, sizeof(CONTEXT)); // Compilações, uma por arquivo fonte
+
+	// Processa as opções da linha de comando
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "-S") == 0)
+			listing = 1;
+		else if (strcmp(argv[i], "-r") == 0)
+			run = 1;
+		else if (strcmp(argv[i], "--stats") == 0)
+			stats_enabled = STATS_TEXT;
+		else if (strcmp(argv[i], "--stats=json") == 0)
+			stats_enabled = STATS_JSON;
+		else if (strcmp(argv[i], "--cache") == 0)
+			use_cache = 1;
+		else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc)
+			output = argv[++i];
+		else if (strcmp(argv[i], "-j") == 0 && i + 1 < argc)
+			nthreads = atoi(argv[++i]);
+		else
+			jobs[nsources++].source = source = argv[i];
+	}
+
+	// Vários arquivos (ou -j): compila todos em paralelo, sem executar
+	if (nsources > 1 || (source && nthreads > 0))
+	{
+		if (run || output || stats_enabled)
+		{
+			fprintf(stderr, "Erro: -r, -o e --stats aceitam um único arquivo-fonte.\n");
+			return 1;
+		}
+		if (nthreads <= 0)
+			nthreads = sysconf(_SC_NPROCESSORS_ONLN);
+
+		for (int i = 0; i < nsources; i++)
+			jobs[i].cache = use_cache;
+
+		// Com -S, o código de cada arquivo vai para <arquivo-fonte>.s
+		for (int i = 0; listing && i < nsources; i++)
+		{
+			char *name = malloc(strlen(jobs[i].source) + 3);
+			sprintf(name, "%s.s", jobs[i].source);
+			jobs[i].output = name;
+		}
+
+		int failed = compile_files(jobs, nsources, nthreads);
+		for (int i = 0; i < nsources; i++)
+			printf("%s: %s\n", jobs[i].source,
+				   jobs[i].status == COMPILE_OK ? "Análise bem-sucedida." : "falhou.");
+		return failed ? 1 : 0;
+	}
+
 	// Verifica se o arquivo fonte foi fornecido como argumento
-	if (argc < 2)
+	if (!source)
 	{
-		fprintf(stderr, "Uso: %s <arquivo-fonte>\n", argv[0]);
+		fprintf(stderr, "Uso: %s [-S] [-r] [--cache] [--stats[=json]] [-o <saida>] <arquivo-fonte>\n"
+						"     %s [-S] [--cache] [-j <threads>] <arquivo-fonte>...\n",
+				argv[0], argv[0]);
 		return 1; // Encerra o programa com código de erro
 	}
 
 	// Tenta abrir o arquivo fonte para leitura
-	src = fopen(argv[1], "r");
+	FILE *src = fopen(source, "r");
 	if (!src)
 	{
 		perror("Erro ao abrir o arquivo-fonte"); // Exibe mensagem de erro se a abertura falhar
 		return 1;								 // Encerra o programa com código de erro
 	}
 
-	// Inicializa o lexer obtendo o primeiro token do arquivo fonte
-	lookahead = gettoken(src);
-
-	// Inicia o processo de parsing
-	mypas();
+	// O relatório de --stats é emitido na saída, inclusive após erros de compilação
+	atexit(stats_report);
 
-	// Fecha o arquivo fonte após o parsing
+	// Carrega o arquivo fonte e o converte inteiro em tokens antes do parsing
+	stats_start(PHASE_FRONTEND);
+	lexer_file(&lexer, src, &identifiers);
 	fclose(src);
-	printf("Análise bem-sucedida.\n"); // Mensagem de sucesso
+	tokenize(&tokens, &lexer);
+
+	// Com --cache, os subprogramas que não mudaram desde a última compilação
+	// são reaproveitados em vez de analisados
+	CACHE procs;
+	if (use_cache)
+	{
+		cache_open(&procs, source);
+		cache = &procs;
+	}
+
+	// Inicia o processo de parsing, que constrói a árvore sintática
+	NODE *program = mypas();
+	typecheck(program); // Anota os tipos e insere as conversões
+	stats_stop(PHASE_FRONTEND);
+
+	// Libera os tokens e o texto do arquivo fonte após o parsing
+	tokens_free(&tokens);
+	lexer_free(&lexer);
+
+	// Gera o código da máquina de pilha a partir da árvore
+	stats_start(PHASE_CODEGEN);
+	codegen(program);
+	stats_stop(PHASE_CODEGEN);
+
+	if (cache)
+	{
+		cache_commit(cache, program); // Guarda o código dos subprogramas analisados
+		cache_free(cache);
+		cache = NULL;
+	}
+	if (!run)
+		printf("Análise bem-sucedida.\n"); // Mensagem de sucesso
+
+	if (listing)
+		codegen_write(stdout); // Escreve o código gerado na saída padrão
+
+	if (output)
+	{
+		FILE *out = fopen(output, "w");
+		if (!out)
+		{
+			perror("Erro ao criar o arquivo de saída");
+			return 1;
+		}
+		codegen_write(out); // Escreve o código gerado no arquivo de saída
+		fclose(out);
+	}
+
+	// Libera de uma só vez toda a memória da árvore e os nomes
+	arena_free(&ast_arena);
+	intern_free(&identifiers);
+
+	if (run)
+	{
+		stats_start(PHASE_RUN);
+		int status = interpret(); // Executa o programa gerado
+		stats_stop(PHASE_RUN);
+		return status;
+	}
 
 	return 0; // Encerra o programa com sucesso
 }
@@ -1,136 +1,451 @@
 // parser.c
+#include <ctype.h>
+#include <errno.h>
+#include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include "lexer.h"
+#include "tokens.h"
 #include "parser.h"
 #include "keywords.h"
 #include "symtab.h"
+#include "ast.h"
+#include "stats.h"
+#include "driver.h"
+#include "cache.h"
 
 // Define o número máximo de identificadores que podem ser armazenados
 #define MAX_IDS 32
 
+// Número de erros após o qual a compilação é interrompida
+#define MAX_ERRORS 20
+
 // Declaração das variáveis globais utilizadas pelo parser
-extern int lookahead; // Token atual
-extern FILE *src;     // Ponteiro para o arquivo fonte
+extern _Thread_local int lookahead; // Token atual
+extern _Thread_local LEXER lexer;   // Analisador léxico do arquivo fonte
+
+// Posição do token atual no vetor de tokens; lookahead == tokens.kinds[tokpos]
+_Thread_local int tokpos = 0;
+
+// Ids dos identificadores de uma lista, suas posições no vetor de tokens e contagem
+_Thread_local int idlist_ids[MAX_IDS]; // Lista de identificadores
+_Thread_local int idlist_pos[MAX_IDS]; // Posição de cada identificador
+_Thread_local int idlist_count = 0;    // Contador de identificadores
 
-// Arrays para armazenar nomes de identificadores e contagem
-char idlist_names[MAX_IDS][MAXIDLEN]; // Lista de identificadores
-int idlist_count = 0;                 // Contador de identificadores
+// Recuperação de erros em modo pânico: após um erro de sintaxe o parser
+// descarta tokens até um ponto de sincronização e suprime novos erros até
+// casar um token com sucesso, pois eles costumam ser consequência do primeiro
+static _Thread_local int errors = 0; // Erros informados na compilação corrente
+static _Thread_local int panic = 0;  // 1 enquanto o parser se recupera de um erro de sintaxe
 
 /**
- * Função principal do parser que inicia a análise sintática.
+ * Coluna do token na posição `pos`, contada a partir do início da linha.
+ * Calculada apenas para as mensagens de erro.
+ */
+static int column(int pos)
+{
+    const char *start = lexer.source + tokens.offsets[pos], *cur = start;
+    while (cur > lexer.source && cur[-1] != '\n')
+        cur--;
+    return start - cur + 1;
+}
+
+/**
+ * Escreve em `buf` a descrição de um token para as mensagens de erro.
  */
-void mypas(void)
+static const char *describe(int token, char *buf, size_t size)
 {
-    match(PROGRAM);                   // Verifica o token PROGRAM
-    match(ID);                        // Verifica um identificador
-    match('(');                       // Verifica o '('
-    idlist();                         // Processa a lista de identificadores
-    match(')');                       // Verifica o ')'
-    match(';');                       // Verifica o ';'
-    block();                          // Processa o bloco de código
-    match('.');                       // Verifica o '.' final
-    symtab_release(current_lexlevel); // Libera símbolos do nível atual
+    switch (token)
+    {
+    case EOF: return "fim de arquivo";
+    case ID: return "identificador";
+    case DEC:
+    case OCT:
+    case HEX: return "número";
+    case ASGN: return "':='";
+    case RELOP_LE: return "'<='";
+    case RELOP_GE: return "'>='";
+    case RELOP_NE: return "'<>'";
+    }
+    if (token >= BEGIN)
+        snprintf(buf, size, "'%s'", keywords[token - BEGIN]);
+    else
+        snprintf(buf, size, "'%c'", token);
+    return buf;
+}
 
+/**
+ * Informa um erro no token da posição `pos`, com linha e coluna. Erros de
+ * sintaxe colocam o parser em modo pânico. Ao atingir MAX_ERRORS erros a
+ * compilação é interrompida.
+ */
+static void report(int pos, int syntax, const char *format, ...)
+{
+    if (panic)
+        return; // Provável consequência de um erro já informado
+
+    char message[512];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(message, sizeof(message), format, args);
+    va_end(args);
+    compile_error("Erro %s na linha %d, coluna %d: %s.", syntax ? "de sintaxe" : "semântico",
+                  tokens.lines[pos], column(pos), message);
+
+    panic = syntax;
+    if (++errors >= MAX_ERRORS)
+    {
+        compile_error("Limite de %d erros atingido; análise interrompida.", MAX_ERRORS);
+        compile_abort();
+    }
+}
+
+/**
+ * Descarta tokens até um ponto de sincronização: ';', BEGIN, END, uma
+ * palavra-chave de declaração, o fim de arquivo ou as palavras UNTIL e ELSE,
+ * que também encerram comandos.
+ */
+static void synchronize(void)
+{
+    while (lookahead != ';' && lookahead != BEGIN && lookahead != END &&
+           lookahead != VAR && lookahead != PROCEDURE && lookahead != FUNCTION &&
+           lookahead != UNTIL && lookahead != ELSE && lookahead != EOF)
+        advance();
+}
+
+/**
+ * Declara um símbolo no nível léxico corrente. Retorna o índice da entrada ou
+ * um valor negativo se o nome já foi declarado no mesmo nível; a tabela cheia
+ * interrompe a compilação.
+ */
+static int declare(int id, int objtype, int type, int parmflag)
+{
+    int sym_index = symtab_append(id, objtype, type, current_lexlevel, parmflag);
+    if (sym_index == -1)
+        compile_abort(); // Tabela cheia, já informada por symtab_append
+    return sym_index;
+}
+
+/**
+ * Valor da constante numérica do token `pos`, convertida na base escolhida
+ * pelo lexer (DEC, OCT ou HEX). Dígitos inválidos na base, como 8 e 9 numa
+ * constante octal, e valores fora do intervalo de long são informados.
+ */
+static long number(int pos)
+{
+    const char *text = lexer.source + tokens.offsets[pos];
+    int base = tokens.kinds[pos] == HEX ? 16 : tokens.kinds[pos] == OCT ? 8 : 10;
+    const char *digits = base == 16 ? text + 2 : text; // Após o prefixo 0x
+    const char *last = digits;                         // Fim do token, como no lexer
+    while (isdigit((unsigned char)*last) || (base == 16 && isxdigit((unsigned char)*last)))
+        last++;
+    int length = last - text;
+
+    char *end;
+    errno = 0;
+    long value = last > digits ? strtol(digits, &end, base) : 0;
+    if (last == digits || end != last)
+        report(pos, 0, "constante '%.*s' inválida na base %d", length, text, base);
+    else if (errno == ERANGE)
+        report(pos, 0, "constante '%.*s' fora do intervalo dos inteiros", length, text);
+    else
+        return value;
+    return 0;
+}
+
+/**
+ * Posição do token seguinte ao ';' que encerra o subprograma iniciado no token
+ * `pos` (PROCEDURE ou FUNCTION), achada apenas pelos tipos dos tokens: os
+ * subprogramas aninhados são percorridos recursivamente e os BEGIN/END do corpo
+ * são contados. Retorna -1 se o subprograma não se fecha.
+ */
+static int procend(int pos)
+{
+    for (pos++; tokens.kinds[pos] != BEGIN; pos++)
+    {
+        if (tokens.kinds[pos] == EOF)
+            return -1;
+        if (tokens.kinds[pos] == PROCEDURE || tokens.kinds[pos] == FUNCTION)
+        {
+            if ((pos = procend(pos)) < 0)
+                return -1;
+            pos--; // O laço avança para o token seguinte ao ';'
+        }
+    }
+
+    int depth = 0;
+    do
+    {
+        if (tokens.kinds[pos] == BEGIN)
+            depth++;
+        else if (tokens.kinds[pos] == END)
+            depth--;
+        else if (tokens.kinds[pos] == EOF)
+            return -1;
+        pos++;
+    } while (depth > 0);
+
+    return tokens.kinds[pos] == ';' ? pos + 1 : -1;
+}
+
+/**
+ * Procura no cache incremental o subprograma que começa no token `start`, cujo
+ * cabeçalho acabou de ser analisado. A chave combina o texto do subprograma com
+ * o hash do ambiente visível (topo da tabela de símbolos). Num acerto, as
+ * chamadas externas do código guardado são ligadas às declarações atuais e o
+ * corpo é pulado. Retorna 1 se o subprograma foi reaproveitado.
+ */
+static int reuse(NODE *proc, int start, int sym_index)
+{
+    if (!cache)
+        return 0;
+
+    PROCACHE *pc = arena_alloc(&ast_arena, sizeof(PROCACHE));
+    pc->symbol = sym_index;
+    proc->u.decl.cache = pc;
+
+    // Com erros a compilação não chega ao fim, e o cache não é gravado
+    int end = sym_index >= 0 && !errors ? procend(start) : -1;
+    if (end < 0)
+        return 0;
+
+    int first = tokens.offsets[start], last = tokens.offsets[end - 1] + 1;
+    pc->key = hash_bytes(symtab[symtab_next_entry - 1].chain, lexer.source + first, last - first);
+
+    CACHEENTRY *entry = cache_find(cache, pc->key);
+    if (entry)
+    {
+        pc->callees = arena_alloc(&ast_arena, (entry->nrelocs + 1) * sizeof(NODE *));
+        for (int k = 0; k < entry->nrelocs; k++)
+        {
+            int s = entry->relocs[k].symbol;
+            if (s <= 0 || s >= symtab_next_entry || !symtab[s].decl || symtab[s].decl->kind != NODE_PROC)
+            {
+                entry = NULL; // Cache inconsistente: analisa o subprograma
+                break;
+            }
+            pc->callees[k] = symtab[s].decl;
+        }
+    }
+    if (!entry)
+    {
+        if (stats_enabled)
+            stats.cache_misses++;
+        return 0;
+    }
+    if (stats_enabled)
+        stats.cache_hits++;
+
+    pc->entry = entry;
+    tokpos = end;
+    lookahead = tokens.kinds[end];
+    return 1;
+}
+
+/**
+ * Declara os procedimentos predefinidos (write e writeln) num nível léxico
+ * abaixo do global, de modo que o programa possa redefini-los.
+ */
+static void builtins(void)
+{
+    static const char *names[] = {"write", "writeln"};
+
+    for (int i = 0; i < 2; i++)
+    {
+        NODE *proc = newnode(NODE_PROC, 0);
+        proc->op = BUILTIN_WRITE + i;
+        proc->u.decl.name = names[i];
+        proc->u.decl.objtype = PROCEDURE_OBJ;
+        proc->u.decl.lexlevel = -1;
+        int id = intern(&identifiers, names[i], strlen(names[i]));
+        symtab[symtab_append(id, PROCEDURE_OBJ, 0, -1, 0)].decl = proc;
+    }
+}
+
+/**
+ * Função principal do parser que inicia a análise sintática.
+ * Retorna a árvore sintática do programa.
+ */
+NODE *mypas(void)
+{
+    builtins(); // Declara os procedimentos predefinidos
+
+    tokpos = 0;
+    lookahead = tokens.kinds[0]; // Primeiro token do arquivo
+    errors = panic = 0;
+
+    NODE *program = newnode(NODE_PROGRAM, tokens.lines[tokpos]);
+    match(PROGRAM);                                           // Verifica o token PROGRAM
+    int name = tokens.ids[tokpos];                                      // Nome do programa
+    match(ID);                                                // Verifica um identificador
+    program->u.blk.name = name >= 0 ? intern_name(&identifiers, name) : ""; // Armazena o nome do programa
+    match('(');                                               // Verifica o '('
+    idlist();                                                 // Processa a lista de identificadores
+    match(')');                                               // Verifica o ')'
+    match(';');                                               // Verifica o ';'
+    if (panic)
+        synchronize();                                        // Recupera-se de um cabeçalho inválido
+    program->u.blk.body = block();                            // Processa o bloco de código
+    match('.');                                               // Verifica o '.' final
+    symtab_release(current_lexlevel);                         // Libera símbolos do nível atual
+    symtab_release(-1);                                       // Libera os procedimentos predefinidos
+
+    // Garante que após o '.' não haja mais tokens
     if (lookahead != EOF)
+        report(tokpos, 1, "caracteres inesperados após o final do programa");
+
+    // A árvore de um programa com erros está incompleta e não segue adiante
+    if (errors)
     {
-        // Garante que após o '.' não haja mais tokens
-        fprintf(stderr, "Erro de sintaxe: caracteres inesperados após o final do programa.\n");
-        exit(EXIT_FAILURE);
+        compile_error("%d erro(s) encontrado(s).", errors);
+        compile_abort();
     }
+
+    return program;
 }
 
 /**
  * Processa um bloco que pode conter declarações e comandos.
  */
-void block(void)
+NODE *block(void)
 {
+    NODE *blk = newnode(NODE_BLOCK, tokens.lines[tokpos]);
     if (lookahead == VAR)
     {
-        vardef(); // Processa definições de variáveis
+        blk->u.blk.vars = vardef(); // Processa definições de variáveis
     }
-    sbprgdef(); // Processa definições de procedimentos e funções
-    beginend(); // Processa o bloco BEGIN ... END
+    blk->u.blk.subprogs = sbprgdef(); // Processa definições de procedimentos e funções
+    blk->u.blk.body = beginend();     // Processa o bloco BEGIN ... END
+    return blk;
 }
 
 /**
  * Processa definições de variáveis.
+ * Retorna a lista de declarações (NODE_VAR).
  */
-void vardef(void)
+NODE *vardef(void)
 {
+    NODE *head = NULL, **tail = &head;
+
     if (lookahead == VAR)
     {
         match(VAR); // Verifica o token VAR
         do
         {
+            int line = tokens.lines[tokpos];
             idlist();                 // Processa a lista de identificadores
             match(':');               // Verifica o ':'
             int var_type = lookahead; // Armazena o tipo da variável
             type();                   // Valida o tipo
             match(';');               // Verifica o ';'
 
-            // Adiciona cada variável à tabela de símbolos
+            // Adiciona cada variável à tabela de símbolos e à lista de declarações
             for (int i = 0; i < idlist_count; i++)
             {
-                if (symtab_append(idlist_names[i], VARIABLE, var_type, current_lexlevel, 0) < 0)
-                {
-                    fprintf(stderr, "Erro semântico: variável '%s' já definida.\n", idlist_names[i]);
-                    exit(EXIT_FAILURE);
-                }
+                const char *name = intern_name(&identifiers, idlist_ids[i]);
+                NODE *var = newnode(NODE_VAR, line);
+                var->type = var_type;
+                var->u.decl.name = name;
+                var->u.decl.objtype = VARIABLE;
+                var->u.decl.lexlevel = current_lexlevel;
+                int sym_index = declare(idlist_ids[i], VARIABLE, var_type, 0);
+                if (sym_index < 0)
+                    report(idlist_pos[i], 0, "variável '%s' já definida", name);
+                else
+                    symtab[sym_index].decl = var;
+                *tail = var;
+                tail = &var->next;
+            }
+
+            // Após um erro, retoma na próxima declaração
+            if (panic)
+            {
+                synchronize();
+                if (lookahead == ';')
+                    match(';');
             }
         } while (lookahead == ID); // Continua enquanto houver IDs
     }
+
+    return head;
 }
 
 /**
  * Processa definições de procedimentos e funções.
+ * Retorna a lista de declarações (NODE_PROC).
  */
-void sbprgdef(void)
+NODE *sbprgdef(void)
 {
+    NODE *head = NULL, **tail = &head;
+
     while (lookahead == PROCEDURE || lookahead == FUNCTION)
     {
+        NODE *proc = newnode(NODE_PROC, tokens.lines[tokpos]);
+        int start = tokpos;
         // Determina se é procedimento ou função
         int objtype = (lookahead == PROCEDURE) ? PROCEDURE_OBJ : FUNCTION_OBJ;
         match(lookahead); // Verifica PROCEDURE ou FUNCTION
-        char proc_func_name[MAXIDLEN];
-        strcpy(proc_func_name, lexeme); // Armazena o nome
-        match(ID);                      // Verifica o ID
-        parmlist();                     // Processa a lista de parâmetros
-        int return_type = 0;
+        int proc_func_id = tokens.ids[tokpos]; // Armazena o nome
+        int proc_func_pos = tokpos;
+        match(ID);                   // Verifica o ID
+        proc->u.decl.name = proc_func_id >= 0 ? intern_name(&identifiers, proc_func_id) : "";
+        proc->u.decl.objtype = objtype;
+        proc->u.decl.lexlevel = current_lexlevel;
+        // Adiciona procedimento ou função à tabela de símbolos antes dos parâmetros,
+        // para que o nome fique no escopo externo e os parâmetros no escopo interno
+        int sym_index = proc_func_id >= 0 ? declare(proc_func_id, objtype, 0, 0) : -2;
+        if (sym_index >= 0)
+            symtab[sym_index].decl = proc;
+        else if (proc_func_id >= 0)
+            report(proc_func_pos, 0, "%s '%s' já definid%s",
+                   objtype == PROCEDURE_OBJ ? "procedimento" : "função",
+                   proc->u.decl.name, objtype == PROCEDURE_OBJ ? "o" : "a");
+        current_lexlevel++;               // Incrementa o nível léxico
+        if (stats_enabled && current_lexlevel > stats.max_lexlevel)
+            stats.max_lexlevel = current_lexlevel;
+        proc->u.decl.params = parmlist(); // Processa a lista de parâmetros
         if (lookahead == ':')
         {
-            match(':');              // Verifica o ':'
-            return_type = lookahead; // Armazena o tipo de retorno
-            type();                  // Valida o tipo
+            match(':');                         // Verifica o ':'
+            if (sym_index >= 0)
+                symtab[sym_index].type = lookahead; // Armazena o tipo de retorno
+            proc->type = lookahead;             // Registra o tipo na declaração
+            type();                             // Valida o tipo
         }
-        // Adiciona procedimento ou função à tabela de símbolos
-        if (symtab_append(proc_func_name, objtype, return_type, current_lexlevel, 0) < 0)
+        match(';');                       // Verifica o ';'
+        if (panic)
+            synchronize();                // Recupera-se de um cabeçalho inválido
+        if (cache && sym_index >= 0)
+            symtab_seal(sym_index);       // Inclui a assinatura no hash do ambiente
+        if (!reuse(proc, start, sym_index))
         {
-            fprintf(stderr, "Erro semântico: %s '%s' já definida.\n",
-                    (objtype == PROCEDURE_OBJ ? "Procedimento" : "Função"),
-                    proc_func_name);
-            exit(EXIT_FAILURE);
+            proc->u.decl.block = block(); // Processa o bloco interno
+            match(';');                   // Verifica o ';'
         }
-        match(';');                       // Verifica o ';'
-        current_lexlevel++;               // Incrementa o nível léxico
-        block();                          // Processa o bloco interno
-        match(';');                       // Verifica o ';'
         symtab_release(current_lexlevel); // Libera símbolos do nível atual
         current_lexlevel--;               // Decrementa o nível léxico
+        *tail = proc;
+        tail = &proc->next;
     }
+
+    return head;
 }
 
 /**
  * Processa a lista de parâmetros em procedimentos ou funções.
+ * Retorna a lista de declarações dos parâmetros (NODE_VAR).
  */
-void parmlist(void)
+NODE *parmlist(void)
 {
+    NODE *head = NULL, **tail = &head;
+
     if (lookahead == '(')
     {
         match('('); // Verifica '('
         do
         {
+            int line = tokens.lines[tokpos];
             int is_var_param = 0;
             if (lookahead == VAR)
             {
@@ -141,15 +456,26 @@ void parmlist(void)
             match(':');                // Verifica ':'
             int parm_type = lookahead; // Armazena o tipo do parâmetro
             type();                    // Valida o tipo
-            // Adiciona parâmetros à tabela de símbolos
+            // Adiciona parâmetros à tabela de símbolos e à lista de declarações
             for (int i = 0; i < idlist_count; i++)
             {
-                if (symtab_append(idlist_names[i], VARIABLE, parm_type, current_lexlevel, is_var_param) < 0)
-                {
-                    fprintf(stderr, "Erro semântico: parâmetro '%s' já definido.\n", idlist_names[i]);
-                    exit(EXIT_FAILURE);
-                }
+                const char *name = intern_name(&identifiers, idlist_ids[i]);
+                NODE *parm = newnode(NODE_VAR, line);
+                parm->type = parm_type;
+                parm->u.decl.name = name;
+                parm->u.decl.objtype = VARIABLE;
+                parm->u.decl.lexlevel = current_lexlevel;
+                parm->u.decl.parmflag = is_var_param;
+                int sym_index = declare(idlist_ids[i], VARIABLE, parm_type, is_var_param);
+                if (sym_index < 0)
+                    report(idlist_pos[i], 0, "parâmetro '%s' já definido", name);
+                else
+                    symtab[sym_index].decl = parm;
+                *tail = parm;
+                tail = &parm->next;
             }
+            if (panic)
+                synchronize(); // Após um erro, retoma na próxima seção de parâmetros
             if (lookahead == ';')
             {
                 match(';'); // Verifica ';' entre parâmetros
@@ -161,6 +487,8 @@ void parmlist(void)
         } while (1);
         match(')'); // Verifica ')'
     }
+
+    return head;
 }
 
 /**
@@ -171,8 +499,14 @@ void idlist(void)
     idlist_count = 0; // Reinicia o contador de identificadores
     do
     {
-        strcpy(idlist_names[idlist_count++], lexeme); // Armazena o identificador atual
-        match(ID);                                    // Verifica o ID
+        if (lookahead == ID && idlist_count == MAX_IDS)
+            report(tokpos, 0, "lista com mais de %d identificadores", MAX_IDS);
+        else if (lookahead == ID)
+        {
+            idlist_pos[idlist_count] = tokpos;
+            idlist_ids[idlist_count++] = tokens.ids[tokpos]; // Armazena o identificador atual
+        }
+        match(ID);                             // Verifica o ID
         if (lookahead == ',')
         {
             match(','); // Verifica a vírgula
@@ -187,144 +521,176 @@ void idlist(void)
 /**
  * Processa um bloco delimitado por BEGIN e END.
  */
-void beginend(void)
+NODE *beginend(void)
 {
-    match(BEGIN); // Verifica BEGIN_TOKEN
-    stmtlist();   // Processa a lista de comandos
-    match(END);   // Verifica END_TOKEN
+    NODE *compound = newnode(NODE_COMPOUND, tokens.lines[tokpos]);
+    match(BEGIN);                  // Verifica BEGIN_TOKEN
+    compound->u.list = stmtlist(); // Processa a lista de comandos
+    match(END);                    // Verifica END_TOKEN
+    return compound;
 }
 
 /**
  * Processa uma lista de comandos separados por ponto e vírgula.
+ * Retorna a lista de comandos encadeada por `next`.
  */
-void stmtlist(void)
+NODE *stmtlist(void)
 {
+    NODE *head = NULL, **tail = &head;
+
     do
     {
-        stmt(); // Processa um comando
-        if (lookahead == ';')
+        NODE *node = stmt(); // Processa um comando
+        if (node)
         {
-            match(';'); // Verifica ';' entre comandos
+            *tail = node;
+            tail = &node->next;
+        }
+        if (panic)
+        {
+            synchronize(); // Após um erro, retoma no próximo comando
+        }
+        if (lookahead == ';' || lookahead == ID || lookahead == BEGIN || lookahead == IF ||
+            lookahead == WHILE || lookahead == REPEAT)
+        {
+            match(';'); // Verifica ';' entre comandos; sem ele, informa o erro e segue no comando seguinte
         }
         else
         {
             break; // Finaliza a lista se não houver ';'
         }
     } while (1);
+
+    return head;
 }
 
 /**
  * Processa um único comando baseado no token atual.
  */
-void stmt(void)
+NODE *stmt(void)
 {
     switch (lookahead)
     {
     case ID:
-        idstmt(); // Processa comando que começa com ID
-        break;
+        return idstmt(); // Processa comando que começa com ID
     case IF:
-        ifstmt(); // Processa comando IF
-        break;
+        return ifstmt(); // Processa comando IF
     case WHILE:
-        whlstmt(); // Processa comando WHILE
-        break;
+        return whlstmt(); // Processa comando WHILE
     case REPEAT:
-        repstmt(); // Processa comando REPEAT
-        break;
+        return repstmt(); // Processa comando REPEAT
     case BEGIN:
-        beginend(); // Processa bloco BEGIN ... END
-        break;
+        return beginend(); // Processa bloco BEGIN ... END
     default:
+    {
         // Erro caso o comando não seja reconhecido
-        fprintf(stderr, "Erro de sintaxe: comando inesperado na linha %d\n", linenum);
-        exit(EXIT_FAILURE);
+        char buf[32];
+        report(tokpos, 1, "comando inesperado, encontrado %s", describe(lookahead, buf, sizeof buf));
+        return NULL;
+    }
     }
 }
 
 /**
  * Processa um comando IF ... THEN ... [ELSE ...].
  */
-void ifstmt(void)
+NODE *ifstmt(void)
 {
-    match(IF);   // Verifica IF
-    expr();      // Processa a expressão condicional
-    match(THEN); // Verifica THEN
-    stmt();      // Processa o comando no THEN
+    NODE *node = newnode(NODE_IF, tokens.lines[tokpos]);
+    match(IF);                // Verifica IF
+    node->u.ctl.cond = expr(); // Processa a expressão condicional
+    match(THEN);              // Verifica THEN
+    node->u.ctl.then = stmt(); // Processa o comando no THEN
     if (lookahead == ELSE)
     {
-        match(ELSE); // Verifica ELSE
-        stmt();      // Processa o comando no ELSE
+        match(ELSE);              // Verifica ELSE
+        node->u.ctl.els = stmt(); // Processa o comando no ELSE
     }
+    return node;
 }
 
 /**
  * Processa um comando REPEAT ... UNTIL ....
  */
-void repstmt(void)
+NODE *repstmt(void)
 {
-    match(REPEAT); // Verifica REPEAT
-    stmtlist();    // Processa a lista de comandos a serem repetidos
-    match(UNTIL);  // Verifica UNTIL
-    expr();        // Processa a condição de parada
+    NODE *node = newnode(NODE_REPEAT, tokens.lines[tokpos]);
+    match(REPEAT);                 // Verifica REPEAT
+    node->u.ctl.then = stmtlist(); // Processa a lista de comandos a serem repetidos
+    match(UNTIL);                  // Verifica UNTIL
+    node->u.ctl.cond = expr();     // Processa a condição de parada
+    return node;
 }
 
 /**
  * Processa um comando WHILE ... DO ....
  */
-void whlstmt(void)
+NODE *whlstmt(void)
 {
-    match(WHILE); // Verifica WHILE
-    expr();       // Processa a condição do loop
-    match(DO);    // Verifica DO
-    stmt();       // Processa o comando dentro do loop
+    NODE *node = newnode(NODE_WHILE, tokens.lines[tokpos]);
+    match(WHILE);              // Verifica WHILE
+    node->u.ctl.cond = expr(); // Processa a condição do loop
+    match(DO);                 // Verifica DO
+    node->u.ctl.then = stmt(); // Processa o comando dentro do loop
+    return node;
 }
 
 /**
  * Processa comandos que começam com um identificador (atribuições ou chamadas).
  */
-void idstmt(void)
+NODE *idstmt(void)
 {
+    NODE *node = NULL;
+
     if (lookahead == ID)
     {
-        int sym_index = symtab_lookup(lexeme, current_lexlevel); // Busca o símbolo na tabela
+        int sym_index = symtab_lookup(tokens.ids[tokpos], current_lexlevel); // Busca o símbolo na tabela
         if (sym_index < 0)
         {
-            // Erro se o símbolo não estiver definido
-            fprintf(stderr, "Erro semântico: variável ou função '%s' não definida.\n", lexeme);
-            exit(EXIT_FAILURE);
+            // Erro se o símbolo não estiver definido; o comando ainda é analisado
+            report(tokpos, 0, "variável ou função '%s' não definida", intern_name(&identifiers, tokens.ids[tokpos]));
         }
-        int objtype = symtab[sym_index].objtype; // Obtém o tipo do objeto
-        match(ID);                               // Verifica o ID
-        if (lookahead == ASGN)
+        NODE *decl = sym_index >= 0 ? symtab[sym_index].decl : NULL;
+        int objtype = sym_index >= 0 ? symtab[sym_index].objtype : VARIABLE; // Obtém o tipo do objeto
+        int line = tokens.lines[tokpos], pos = tokpos;
+        int assign = peek(1) == ASGN; // O token seguinte distingue atribuição de chamada
+        match(ID);                    // Verifica o ID
+        if (assign)
         {
             // Verifica se é uma variável ou função que pode receber atribuição
             if (objtype != VARIABLE && objtype != FUNCTION_OBJ)
-            {
-                fprintf(stderr, "Erro semântico: não é possível atribuir a '%s'.\n", lexeme);
-                exit(EXIT_FAILURE);
-            }
-            match(ASGN); // Verifica ':='
-            expr();      // Processa a expressão de atribuição
+                report(pos, 0, "não é possível atribuir a '%s'", symtab[sym_index].name);
+            node = newnode(NODE_ASSIGN, line);
+            node->u.ref.decl = decl;
+            match(ASGN);               // Verifica ':='
+            node->u.ref.args = expr(); // Processa a expressão de atribuição
         }
         else
         {
-            exprlist(); // Processa uma lista de expressões (possível chamada de procedimento)
+            node = newnode(NODE_CALL, line);
+            node->u.ref.decl = decl;
+            node->u.ref.args = exprlist(); // Processa uma lista de expressões (possível chamada de procedimento)
         }
     }
+
+    return node;
 }
 
 /**
  * Processa uma lista de expressões separadas por vírgulas.
+ * Retorna a lista de expressões encadeada por `next`.
  */
-void exprlist(void)
+NODE *exprlist(void)
 {
+    NODE *head = NULL, **tail = &head;
+
     if (lookahead == '(')
     {
         match('('); // Verifica '('
         do
         {
-            expr(); // Processa uma expressão
+            if ((*tail = expr())) // Processa uma expressão; uma expressão inválida não entra na lista
+                tail = &(*tail)->next;
             if (lookahead == ',')
             {
                 match(','); // Verifica vírgula entre expressões
@@ -336,6 +702,8 @@ void exprlist(void)
         } while (1);
         match(')'); // Verifica ')'
     }
+
+    return head;
 }
 
 /**
@@ -358,89 +726,115 @@ void type(void)
         match(BOOLEAN); // Verifica BOOLEAN
         break;
     default:
+    {
         // Erro caso o tipo não seja válido
-        fprintf(stderr, "Erro: tipo inválido na linha %d.\n", linenum);
-        exit(-1);
+        char buf[32];
+        report(tokpos, 1, "tipo inválido, encontrado %s", describe(lookahead, buf, sizeof buf));
+    }
     }
 }
 
+/**
+ * Cria um nó de operação binária.
+ */
+static NODE *binop(int op, NODE *left, NODE *right, int line)
+{
+    NODE *node = newnode(NODE_BINOP, line);
+    node->op = op;
+    node->u.bin.left = left;
+    node->u.bin.right = right;
+    return node;
+}
+
 /**
  * Processa uma expressão completa, possivelmente com operadores relacionais.
  */
-void expr(void)
+NODE *expr(void)
 {
-    smpexpr(); // Processa uma expressão simples
+    NODE *node = smpexpr(); // Processa uma expressão simples
 
     // Verifica se há um operador relacional após a expressão simples
-    if (lookahead == '<' || lookahead == '>' || lookahead == RELOP_LE ||
+    if (lookahead == '<' || lookahead == '>' || lookahead == '=' || lookahead == RELOP_LE ||
         lookahead == RELOP_GE || lookahead == RELOP_NE)
     {
-        match(lookahead); // Consome o operador relacional
-        smpexpr();        // Processa a próxima expressão simples
+        int op = lookahead, line = tokens.lines[tokpos];
+        match(lookahead);                       // Consome o operador relacional
+        node = binop(op, node, smpexpr(), line); // Processa a próxima expressão simples
     }
+
+    return node;
 }
 
 /**
- * Processa uma expressão simples com operadores de soma e subtração.
+ * Processa uma expressão simples com operadores de soma, subtração e "or".
  */
-void smpexpr(void)
+NODE *smpexpr(void)
 {
-    term(); // Processa o primeiro termo
+    NODE *node = term(); // Processa o primeiro termo
 
-    // Continua processando enquanto houver operadores '+' ou '-'
-    while (lookahead == '+' || lookahead == '-')
+    // Continua processando enquanto houver operadores '+', '-' ou 'or'
+    while (lookahead == '+' || lookahead == '-' || lookahead == OR)
     {
-        match(lookahead); // Consome o operador
-        term();           // Processa o próximo termo
+        int op = lookahead, line = tokens.lines[tokpos];
+        match(lookahead);                    // Consome o operador
+        node = binop(op, node, term(), line); // Processa o próximo termo
     }
+
+    return node;
 }
 
 /**
- * Processa um termo com operadores de multiplicação e divisão.
+ * Processa um termo com operadores de multiplicação, divisão e "and".
  */
-void term(void)
+NODE *term(void)
 {
-    factor(); // Processa o primeiro fator
+    NODE *node = factor(); // Processa o primeiro fator
 
-    // Continua processando enquanto houver operadores '*', '/' ou 'mod', 'div'
-    while (lookahead == '*' || lookahead == '/' || lookahead == MOD || lookahead == DIV)
+    // Continua processando enquanto houver operadores '*', '/', 'mod', 'div' ou 'and'
+    while (lookahead == '*' || lookahead == '/' || lookahead == MOD || lookahead == DIV || lookahead == AND)
     {
-        match(lookahead); // Consome o operador
-        factor();         // Processa o próximo fator
+        int op = lookahead, line = tokens.lines[tokpos];
+        match(lookahead);                      // Consome o operador
+        node = binop(op, node, factor(), line); // Processa o próximo fator
     }
+
+    return node;
 }
 
 /**
- * Processa um fator que pode ser um identificador, número ou expressão entre parênteses.
+ * Processa um fator que pode ser um identificador, número, negação ou expressão entre parênteses.
  */
-void factor(void)
+NODE *factor(void)
 {
+    NODE *node = NULL;
+    int line = tokens.lines[tokpos];
 
     switch (lookahead)
     {
     case ID:
     {
         // Verifica se o identificador está definido na tabela de símbolos
-        int sym_index = symtab_lookup(lexeme, current_lexlevel);
+        int sym_index = symtab_lookup(tokens.ids[tokpos], current_lexlevel);
         if (sym_index < 0)
-        {
-            fprintf(stderr, "Erro semântico: símbolo '%s' não definido.\n", lexeme);
-            exit(EXIT_FAILURE);
-        }
-        int objtype = symtab[sym_index].objtype; // Obtém o tipo do objeto
+            report(tokpos, 0, "símbolo '%s' não definido", intern_name(&identifiers, tokens.ids[tokpos]));
+        int objtype = sym_index >= 0 ? symtab[sym_index].objtype : VARIABLE; // Obtém o tipo do objeto
         match(ID);                               // Verifica o ID
 
         if (lookahead == '(')
         {
             // Processa parâmetros de função ou procedimento
+            node = newnode(NODE_CALL, line);
+            NODE **tail = &node->u.ref.args;
             match('(');
             if (lookahead != ')')
             {
-                expr();
+                if ((*tail = expr()))
+                    tail = &(*tail)->next;
                 while (lookahead == ',')
                 {
                     match(',');
-                    expr();
+                    if ((*tail = expr()))
+                        tail = &(*tail)->next;
                 }
             }
             match(')'); // Verifica ')'
@@ -448,25 +842,63 @@ void factor(void)
         else if (objtype == FUNCTION_OBJ)
         {
             // Funções sem parâmetros não precisam de parênteses
-            // Nenhuma ação necessária
+            node = newnode(NODE_CALL, line);
         }
+        else
+        {
+            node = newnode(NODE_VARREF, line);
+        }
+        node->u.ref.decl = sym_index >= 0 ? symtab[sym_index].decl : NULL;
         break;
     }
     case DEC:
     case OCT:
     case HEX:
-        match(lookahead); // Processa números (decimal, octal, hexadecimal)
+        node = newnode(NODE_NUM, line);
+        node->u.value = number(tokpos);          // Converte na base do token
+        match(lookahead);                        // Processa números (decimal, octal, hexadecimal)
         break;
     case '(':
-        match('('); // Verifica '('
-        expr();     // Processa a expressão dentro dos parênteses
-        match(')'); // Verifica ')'
+        match('(');    // Verifica '('
+        node = expr(); // Processa a expressão dentro dos parênteses
+        match(')');    // Verifica ')'
+        break;
+    case NOT:
+        node = newnode(NODE_UNOP, line);
+        node->op = NOT;
+        match(NOT);                  // Verifica 'not'
+        node->u.bin.left = factor(); // Processa o fator negado
         break;
     default:
-        // Erro caso o fator não seja válido
-        fprintf(stderr, "Erro de sintaxe: fator inválido na linha %d, token: %d\n", linenum, lookahead);
-        exit(EXIT_FAILURE);
+    {
+        // Erro caso o fator não seja válido; o chamador segue com o fator ausente
+        char buf[32];
+        report(tokpos, 1, "fator inválido, encontrado %s", describe(lookahead, buf, sizeof buf));
+    }
     }
+
+    return node;
+}
+
+/**
+ * Retorna o token `k` posições adiante do atual (peek(0) é o lookahead). Além
+ * do fim do arquivo retorna sempre o fim de arquivo.
+ */
+int peek(int k)
+{
+    int pos = tokpos + k;
+    return pos < tokens.count ? tokens.kinds[pos] : -1;
+}
+
+/**
+ * Avança para o próximo token; o fim de arquivo, último do vetor, nunca é
+ * ultrapassado.
+ */
+void advance(void)
+{
+    if (tokpos < tokens.count - 1)
+        tokpos++;
+    lookahead = tokens.kinds[tokpos];
 }
 
 /**
@@ -479,7 +911,8 @@ void match(int token)
 
     if (lookahead == token)
     {
-        lookahead = gettoken(src); // Avança para o próximo token
+        advance();  // Avança para o próximo token
+        panic = 0;  // Um token casado encerra a recuperação de erro
     }
     else
     {
@@ -489,8 +922,10 @@ void match(int token)
             return; // Sucesso, encontrado o final do programa
         }
 
-        // Erro caso o token não corresponda ao esperado
-        fprintf(stderr, "Erro de sintaxe: esperado %d, mas encontrado %d na linha %d\n", token, lookahead, linenum);
-        exit(EXIT_FAILURE);
+        // Erro caso o token não corresponda ao esperado; o token atual não é
+        // consumido, como se o esperado estivesse ausente
+        char expected[32], found[32];
+        report(tokpos, 1, "esperado %s, encontrado %s", describe(token, expected, sizeof expected),
+               describe(lookahead, found, sizeof found));
     }
 }
@@ -5,26 +5,29 @@
 #include "lexer.h"
 #include "symtab.h"
 #include "keywords.h"
+#include "ast.h"
 
-void mypas(void);      // Função principal do parser
-void block(void);      // Analisa um bloco de código (declaracoes e comandos)
-void vardef(void);     // Analisa definições de variáveis
-void sbprgdef(void);   // Analisa definições de procedimentos e funções
-void parmlist(void);   // Analisa listas de parâmetros
+NODE *mypas(void);     // Função principal do parser; retorna a árvore do programa
+NODE *block(void);     // Analisa um bloco de código (declaracoes e comandos)
+NODE *vardef(void);    // Analisa definições de variáveis
+NODE *sbprgdef(void);  // Analisa definições de procedimentos e funções
+NODE *parmlist(void);  // Analisa listas de parâmetros
 void idlist(void);     // Analisa listas de identificadores
-void beginend(void);   // Analisa blocos BEGIN ... END
-void stmtlist(void);   // Analisa listas de comandos
-void stmt(void);       // Analisa um único comando
-void idstmt(void);     // Analisa comandos que começam com um identificador
-void exprlist(void);   // Analisa listas de expressões
-void ifstmt(void);     // Analisa comandos IF
-void whlstmt(void);    // Analisa comandos WHILE
-void repstmt(void);    // Analisa comandos REPEAT ... UNTIL
-void expr(void);       // Analisa expressões completas
-void smpexpr(void);    // Analisa expressões simples (sem operadores relacionais)
-void term(void);       // Analisa termos em expressões (com multiplicação/divisão)
-void factor(void);     // Analisa fatores em termos (identificadores, números, subexpressões)
+NODE *beginend(void);  // Analisa blocos BEGIN ... END
+NODE *stmtlist(void);  // Analisa listas de comandos
+NODE *stmt(void);      // Analisa um único comando
+NODE *idstmt(void);    // Analisa comandos que começam com um identificador
+NODE *exprlist(void);  // Analisa listas de expressões
+NODE *ifstmt(void);    // Analisa comandos IF
+NODE *whlstmt(void);   // Analisa comandos WHILE
+NODE *repstmt(void);   // Analisa comandos REPEAT ... UNTIL
+NODE *expr(void);      // Analisa expressões completas
+NODE *smpexpr(void);   // Analisa expressões simples (sem operadores relacionais)
+NODE *term(void);      // Analisa termos em expressões (com multiplicação/divisão)
+NODE *factor(void);    // Analisa fatores em termos (identificadores, números, subexpressões)
 void match(int token); // Verifica e consome o token esperado
+int peek(int k);       // Retorna o token k posições adiante do atual
+void advance(void);    // Avança para o próximo token
 void type(void);       // Analisa tipos de dados (INTEGER, REAL, etc.)
 
 #endif // PARSER_H
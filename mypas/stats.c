@@ -0,0 +1,99 @@
+// stats.c
+#include <stdio.h>
+#include <time.h>
+#include "stats.h"
+
+STATS stats;           // Medições da execução corrente
+int stats_enabled = 0; // STATS_OFF, STATS_TEXT ou STATS_JSON
+
+/**
+ * Relógio monotônico em segundos.
+ */
+double stats_clock(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/**
+ * Marca o início de uma fase.
+ */
+void stats_start(int phase)
+{
+    if (stats_enabled)
+        stats.phase_start[phase] = stats_clock();
+}
+
+/**
+ * Marca o fim de uma fase, acumulando o seu tempo.
+ */
+void stats_stop(int phase)
+{
+    if (stats_enabled && stats.phase_start[phase] > 0)
+    {
+        stats.phase_time[phase] += stats_clock() - stats.phase_start[phase];
+        stats.phase_start[phase] = 0;
+    }
+}
+
+/**
+ * Escreve o relatório na saída de erros. Registrada com atexit, de modo que o
+ * relatório sai também quando a compilação termina por um erro; fases ainda
+ * em andamento são encerradas neste momento.
+ */
+void stats_report(void)
+{
+    if (!stats_enabled)
+        return;
+
+    for (int phase = 0; phase < NPHASES; phase++)
+        stats_stop(phase);
+
+    // O tempo da análise sintática exclui o do lexer e o da tabela de símbolos
+    double parse_time = stats.phase_time[PHASE_FRONTEND] - stats.lex_time - stats.symtab_time;
+    double total = stats.phase_time[PHASE_FRONTEND] + stats.phase_time[PHASE_CODEGEN] + stats.phase_time[PHASE_RUN];
+    double avg_lookup = stats.lookups ? (double)stats.lookup_probes / stats.lookups : 0.0;
+    double avg_append = stats.appends ? (double)stats.append_probes / stats.appends : 0.0;
+
+    fflush(stdout);
+    if (stats_enabled == STATS_JSON)
+    {
+        fprintf(stderr,
+                "{\"time\": {\"lexer\": %.6f, \"parser\": %.6f, \"symtab\": %.6f, "
+                "\"codegen\": %.6f, \"run\": %.6f, \"total\": %.6f}, "
+                "\"tokens\": %ld, "
+                "\"symtab_lookup\": {\"calls\": %ld, \"probes\": %ld, \"max_probe\": %ld}, "
+                "\"symtab_append\": {\"calls\": %ld, \"probes\": %ld, \"max_probe\": %ld}, "
+                "\"symtab_release\": {\"calls\": %ld}, "
+                "\"max_lexlevel\": %d, \"peak_symbols\": %d, "
+                "\"cache\": {\"hits\": %ld, \"misses\": %ld}}\n",
+                stats.lex_time, parse_time, stats.symtab_time,
+                stats.phase_time[PHASE_CODEGEN], stats.phase_time[PHASE_RUN], total,
+                stats.tokens,
+                stats.lookups, stats.lookup_probes, stats.max_lookup_probe,
+                stats.appends, stats.append_probes, stats.max_append_probe,
+                stats.releases, stats.max_lexlevel, stats.peak_symbols,
+                stats.cache_hits, stats.cache_misses);
+        return;
+    }
+
+    fprintf(stderr, "Estatísticas:\n");
+    fprintf(stderr, "  análise léxica      %10.3f ms\n", stats.lex_time * 1e3);
+    fprintf(stderr, "  análise sintática   %10.3f ms\n", parse_time * 1e3);
+    fprintf(stderr, "  tabela de símbolos  %10.3f ms\n", stats.symtab_time * 1e3);
+    fprintf(stderr, "  geração de código   %10.3f ms\n", stats.phase_time[PHASE_CODEGEN] * 1e3);
+    fprintf(stderr, "  execução            %10.3f ms\n", stats.phase_time[PHASE_RUN] * 1e3);
+    fprintf(stderr, "  total               %10.3f ms\n", total * 1e3);
+    fprintf(stderr, "  tokens: %ld\n", stats.tokens);
+    fprintf(stderr, "  symtab_lookup: %ld chamadas, sondagem média %.2f, máxima %ld\n",
+            stats.lookups, avg_lookup, stats.max_lookup_probe);
+    fprintf(stderr, "  symtab_append: %ld chamadas, sondagem média %.2f, máxima %ld\n",
+            stats.appends, avg_append, stats.max_append_probe);
+    fprintf(stderr, "  symtab_release: %ld chamadas\n", stats.releases);
+    fprintf(stderr, "  nível léxico máximo: %d\n", stats.max_lexlevel);
+    fprintf(stderr, "  pico de símbolos: %d\n", stats.peak_symbols);
+    if (stats.cache_hits || stats.cache_misses)
+        fprintf(stderr, "  cache: %ld subprograma(s) reaproveitado(s), %ld analisado(s)\n",
+                stats.cache_hits, stats.cache_misses);
+}
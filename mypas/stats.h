@@ -0,0 +1,53 @@
+// stats.h
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdio.h>
+
+// Fases cronometradas pelo programa principal
+enum
+{
+    PHASE_FRONTEND, // Análise léxica, sintática e de tipos, com a tabela de símbolos
+    PHASE_CODEGEN,  // Geração de código
+    PHASE_RUN,      // Execução
+    NPHASES
+};
+
+// Modos de relatório (--stats e --stats=json)
+enum
+{
+    STATS_OFF,
+    STATS_TEXT,
+    STATS_JSON,
+};
+
+// Medições coletadas durante a compilação quando stats_enabled != STATS_OFF
+typedef struct
+{
+    double phase_time[NPHASES];  // Tempo de parede de cada fase, em segundos
+    double phase_start[NPHASES]; // Início da fase em andamento (0 = parada)
+    double lex_time;             // Tempo gasto em gettoken (parte do front end)
+    double symtab_time;          // Tempo gasto na tabela de símbolos (parte do front end)
+    long tokens;                 // Tokens devolvidos por gettoken
+    long lookups;                // Chamadas de symtab_lookup
+    long lookup_probes;          // Entradas visitadas por symtab_lookup
+    long max_lookup_probe;       // Maior número de entradas visitadas numa busca
+    long appends;                // Chamadas de symtab_append
+    long append_probes;          // Entradas visitadas na verificação de duplicatas
+    long max_append_probe;       // Maior número de entradas visitadas numa inserção
+    long releases;               // Chamadas de symtab_release
+    int max_lexlevel;            // Maior nível léxico alcançado
+    int peak_symbols;            // Maior número de símbolos simultâneos
+    long cache_hits;             // Subprogramas reaproveitados do cache incremental
+    long cache_misses;           // Subprogramas analisados com o cache ativo
+} STATS;
+
+extern STATS stats;
+extern int stats_enabled;
+
+double stats_clock(void);
+void stats_start(int phase);
+void stats_stop(int phase);
+void stats_report(void);
+
+#endif
@@ -1,102 +1,209 @@
 #include <string.h>
 #include <symtab.h>
 #include "keywords.h"
+#include "stats.h"
+#include "cache.h"
+#include "driver.h"
 
-#define MAXSYMTABSIZE 16384 // Define o tamanho máximo da tabela de símbolos
+#define HASHSIZE 4096       // Número de buckets do índice hash (potência de 2)
 
 // Declaração da tabela de símbolos como um array de estruturas _symtab_
-// Cada entrada na tabela representa um símbolo (variável, função, procedimento, etc.)
-struct _symtab_ symtab[MAXSYMTABSIZE];
+// As entradas são empilhadas na ordem de declaração, de modo que os símbolos
+// de um escopo ficam sempre acima dos símbolos dos escopos que o envolvem.
+// A entrada 0 não é usada e serve como "nulo" nos encadeamentos.
+_Thread_local struct _symtab_ symtab[MAXSYMTABSIZE];
 
-// Variável que indica a próxima entrada disponível na tabela de símbolos
-int symtab_next_entry = 1;
+// Variável que indica a próxima entrada disponível na tabela de símbolos (topo da pilha)
+_Thread_local int symtab_next_entry = 1;
+
+// Índice hash: cada bucket aponta para o símbolo mais recente com aquele hash,
+// e os demais são encadeados pelo campo `next` (do mais interno para o mais externo)
+static _Thread_local int symtab_hash[HASHSIZE];
 
 // Variável que rastreia o nível léxico atual (escopo atual)
-int current_lexlevel = 0;
+_Thread_local int current_lexlevel = 0;
+
+/**
+ * Bucket de um nome. Os ids da tabela de identificadores são consecutivos, de
+ * modo que os seus bits baixos já distribuem os nomes sem colisões até HASHSIZE.
+ */
+static unsigned symtab_hashname(int id)
+{
+    return (unsigned)id & (HASHSIZE - 1);
+}
 
 /**
- * Esta função percorre a tabela de símbolos para encontrar um símbolo que corresponda
- * ao nome fornecido (`query`) e que esteja no nível léxico especificado (`lexlevel`).
- * A busca começa no nível léxico fornecido e vai descendo até o nível global (0).
+ * Procura o símbolo `query` visível no nível léxico `lexlevel`, contando em
+ * `probes` as entradas visitadas.
+ * Como cada bucket é encadeado do escopo mais interno para o mais externo, a primeira
+ * ocorrência encontrada é a que sombreia as demais.
  */
-int symtab_lookup(const char *query, int lexlevel)
+static int symtab_find(int query, int lexlevel, long *probes)
 {
-    // Percorre os níveis léxicos do atual até o nível global
-    for (int level = lexlevel; level >= 0; level--)
+    // Percorre apenas os símbolos cujo nome cai no mesmo bucket
+    for (int i = symtab_hash[symtab_hashname(query)]; i; i = symtab[i].next)
     {
-        // Percorre todas as entradas da tabela de símbolos
-        for (int i = 0; i < MAXSYMTABSIZE; i++)
+        ++*probes;
+        if (symtab[i].id == query && symtab[i].lexlevel <= lexlevel)
         {
-            // Verifica se a entrada está ocupada (nome não vazio),
-            // se o nome corresponde ao `query` e se está no nível léxico atual
-            if (symtab[i].name[0] != '\0' && strcmp(symtab[i].name, query) == 0 && symtab[i].lexlevel == level)
-            {
-                return i; // Retorna o índice do símbolo encontrado
-            }
+            return i; // Retorna o índice do símbolo encontrado
         }
     }
     return -1; // Retorna -1 se o símbolo não for encontrado em nenhum nível léxico
 }
 
 /**
- * Esta função tenta adicionar um símbolo com o nome fornecido (`name`), tipo de objeto (`objtype`),
+ * Acrescenta ao hash `h` os atributos da entrada `i` que determinam o código
+ * gerado para quem a usa. O nome entra pelo texto, pois os ids dependem da
+ * ordem em que os identificadores aparecem no arquivo.
+ */
+static HASH symtab_hashentry(HASH h, int i)
+{
+    h = hash_bytes(h, symtab[i].name, strlen(symtab[i].name) + 1);
+    h = hash_int(h, symtab[i].objtype);
+    h = hash_int(h, symtab[i].type);
+    h = hash_int(h, symtab[i].lexlevel);
+    return hash_int(h, symtab[i].parmflag);
+}
+
+/**
+ * Esta função procura um símbolo que corresponda ao id de nome fornecido (`query`) e que
+ * esteja visível no nível léxico especificado (`lexlevel`).
+ */
+int symtab_lookup(int query, int lexlevel)
+{
+    long probes = 0;
+
+    if (!stats_enabled)
+        return symtab_find(query, lexlevel, &probes);
+
+    double start = stats_clock();
+    int found = symtab_find(query, lexlevel, &probes);
+    stats.symtab_time += stats_clock() - start;
+    stats.lookups++;
+    stats.lookup_probes += probes;
+    if (probes > stats.max_lookup_probe)
+        stats.max_lookup_probe = probes;
+    return found;
+}
+
+/**
+ * Esta função tenta adicionar um símbolo com o id de nome fornecido (`id`), tipo de objeto (`objtype`),
  * tipo de dado (`type`), nível léxico (`lexlevel`) e flag de parâmetro (`parmflag`).
- * Antes de adicionar, verifica se o símbolo já existe no nível léxico especificado.
+ * Antes de adicionar, verifica se o símbolo já existe no próprio nível léxico; símbolos de
+ * escopos externos com o mesmo nome são apenas sombreados.
+ * Retorna o índice da nova entrada em caso de sucesso.
  */
-int symtab_append(const char *name, int objtype, int type, int lexlevel, int parmflag)
+int symtab_append(int id, int objtype, int type, int lexlevel, int parmflag)
 {
+    double start = stats_enabled ? stats_clock() : 0.0;
+    unsigned h = symtab_hashname(id);
+    const char *name = intern_name(&identifiers, id);
+    long probes = 0;
+
     // Verifica se o símbolo já existe no nível léxico especificado
-    if (symtab_lookup(name, lexlevel) >= 0)
+    int found = symtab_find(id, lexlevel, &probes);
+    if (stats_enabled)
+    {
+        stats.appends++;
+        stats.append_probes += probes;
+        if (probes > stats.max_append_probe)
+            stats.max_append_probe = probes;
+    }
+    if (found >= 0 && symtab[found].lexlevel == lexlevel)
     {
-        // Imprime mensagem de erro se o símbolo já foi definido no escopo
-        fprintf(stderr, "Erro semântico: o símbolo '%s' já foi definido no nível léxico %d.\n", name, lexlevel);
+        // O chamador informa o erro, com a posição da declaração repetida
         return -2; // Retorna -2 indicando que o símbolo já existe no escopo
     }
 
-    // Percorre a tabela de símbolos para encontrar uma entrada livre
-    for (int i = 0; i < MAXSYMTABSIZE; i++)
+    // Se o topo da pilha alcançou o limite, a tabela está cheia
+    if (symtab_next_entry >= MAXSYMTABSIZE)
     {
-        // Verifica se a entrada está livre (nome vazio)
-        if (symtab[i].name[0] == '\0')
-        {
-            // Copia o nome do símbolo para a tabela, garantindo a terminação da string
-            strncpy(symtab[i].name, name, sizeof(symtab[i].name) - 1);
-            symtab[i].name[sizeof(symtab[i].name) - 1] = '\0'; // Garante a terminação com '\0'
+        compile_error("Erro: tabela de símbolos cheia.");
+        return -1; // Retorna -1 indicando que a tabela está cheia
+    }
 
-            // Preenche os demais campos da estrutura com as informações fornecidas
-            symtab[i].objtype = objtype;
-            symtab[i].type = type;
-            symtab[i].lexlevel = lexlevel; // Registra o nível léxico do símbolo
-            symtab[i].parmflag = parmflag; // Indica se é um parâmetro
+    int i = symtab_next_entry++;
 
-            return 0; // Retorna 0 indicando sucesso na adição
-        }
+    // O nome não é copiado: aponta para a cópia única da tabela de identificadores
+    symtab[i].id = id;
+    symtab[i].name = name;
+
+    // Preenche os demais campos da estrutura com as informações fornecidas
+    symtab[i].objtype = objtype;
+    symtab[i].type = type;
+    symtab[i].lexlevel = lexlevel; // Registra o nível léxico do símbolo
+    symtab[i].parmflag = parmflag; // Indica se é um parâmetro
+
+    // Hash do ambiente visível até esta entrada, usado só pelo cache incremental
+    if (cache)
+        symtab[i].chain = symtab_hashentry(symtab[i - 1].chain, i);
+
+    // Insere a entrada no início do bucket, sombreando declarações externas
+    symtab[i].next = symtab_hash[h];
+    symtab_hash[h] = i;
+
+    if (stats_enabled)
+    {
+        if (i > stats.peak_symbols)
+            stats.peak_symbols = i; // A entrada 0 não é usada: i símbolos na tabela
+        stats.symtab_time += stats_clock() - start;
     }
 
-    // Se não encontrou uma posição livre, a tabela está cheia
-    fprintf(stderr, "Erro: tabela de símbolos cheia.\n");
-    return -1; // Retorna -1 indicando que a tabela está cheia
+    return i; // Retorna o índice da nova entrada
 }
 
 /**
  * Esta função é chamada quando se sai de um escopo (nível léxico) para remover símbolos
  * que não são mais válidos no escopo atual.
+ * Os símbolos do escopo que se fecha estão no topo da pilha e são sempre a cabeça dos
+ * seus buckets, então basta desempilhá-los.
  */
 void symtab_release(int lexlevel)
 {
-    // Percorre todas as entradas da tabela de símbolos
-    for (int i = 0; i < MAXSYMTABSIZE; i++)
+    double start = stats_enabled ? stats_clock() : 0.0;
+
+    while (symtab_next_entry > 1 && symtab[symtab_next_entry - 1].lexlevel >= lexlevel)
     {
-        // Verifica se a entrada está no nível léxico a ser liberado
-        if (symtab[i].lexlevel == lexlevel)
-        {
-            // Marca a entrada como livre definindo o primeiro caractere do nome como '\0'
-            symtab[i].name[0] = '\0';
-            // Opcionalmente, você pode limpar os demais campos para evitar resíduos
-            symtab[i].objtype = 0;
-            symtab[i].type = 0;
-            symtab[i].lexlevel = 0;
-            symtab[i].parmflag = 0;
-        }
+        int i = --symtab_next_entry;
+
+        // Remove a entrada do início do seu bucket
+        symtab_hash[symtab_hashname(symtab[i].id)] = symtab[i].next;
+
+        // Limpa a entrada para evitar resíduos
+        memset(&symtab[i], 0, sizeof(symtab[i]));
+    }
+
+    if (stats_enabled)
+    {
+        stats.releases++;
+        stats.symtab_time += stats_clock() - start;
     }
 }
+
+/**
+ * Completa a entrada do subprograma `index` depois do cabeçalho: o hash passa a
+ * incluir o tipo de retorno e os parâmetros, que estão logo acima dela na pilha,
+ * de modo que o ambiente de quem o chama muda junto com a assinatura. Os hashes
+ * dos parâmetros são refeitos a partir do novo valor. Chamado só com --cache.
+ */
+void symtab_seal(int index)
+{
+    HASH h = symtab_hashentry(symtab[index - 1].chain, index);
+    for (int i = index + 1; i < symtab_next_entry; i++)
+        h = symtab_hashentry(h, i);
+    symtab[index].chain = h;
+
+    for (int i = index + 1; i < symtab_next_entry; i++)
+        symtab[i].chain = symtab_hashentry(symtab[i - 1].chain, i);
+}
+
+/**
+ * Esvazia a tabela de símbolos e volta ao nível léxico global, inclusive após
+ * uma compilação interrompida no meio de um escopo.
+ */
+void symtab_reset(void)
+{
+    symtab_release(-1);
+    current_lexlevel = 0;
+}
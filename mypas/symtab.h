@@ -5,23 +5,34 @@
 #define PROCEDURE_OBJ 2
 #define FUNCTION_OBJ 3
 
+#define MAXSYMTABSIZE 16384 // Define o tamanho máximo da tabela de símbolos
+
 #include "lexer.h"
 #include "keywords.h"
 
+struct _node_;
+
 typedef struct _symtab_
 {
-    char name[MAXIDLEN];
+    int id;              // Id do nome na tabela de identificadores
+    const char *name;    // Nome, para mensagens de erro
     int objtype;
     int type;
     int lexlevel;
     int parmflag;
+    int next;            // Próximo símbolo no mesmo bucket do índice hash
+    struct _node_ *decl; // Declaração do símbolo na árvore sintática
+    unsigned long long chain; // Hash desta entrada e de todas as abaixo dela na pilha
 } SYMTAB;
 
-extern SYMTAB symtab[];
-extern int current_lexlevel;
+extern _Thread_local SYMTAB symtab[];
+extern _Thread_local int current_lexlevel;
+extern _Thread_local int symtab_next_entry;
 
-int symtab_append(const char *name, int objtype, int type, int lexlevel, int parmflag);
-int symtab_lookup(const char *query, int lexlevel);
+int symtab_append(int id, int objtype, int type, int lexlevel, int parmflag);
+int symtab_lookup(int query, int lexlevel);
 void symtab_release(int lexlevel);
+void symtab_seal(int index);
+void symtab_reset(void);
 
 #endif
@@ -0,0 +1,10 @@
+program teste (input, output);
+var x, y: integer;
+    b: boolean;
+begin
+	x := 17 mod 5;
+	y := x div 2;
+	b := not (x > y) and (y <> 0) or (x <= 1);
+	if not b then
+		x := y
+end.
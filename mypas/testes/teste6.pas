@@ -0,0 +1,37 @@
+program teste (input, output);
+var n, r: integer;
+	procedure swap(var a: integer; var b: integer);
+		var t: integer;
+		begin
+			t := a;
+			a := b;
+			b := t
+		end;
+	function factorial(n: integer) : integer;
+		begin
+			if n > 1 then
+				factorial := factorial(n - 1) * n
+			else
+				factorial := 1
+		end;
+	procedure count(k: integer);
+		var i: integer;
+		procedure show(v: integer);
+			begin
+				writeln(k, v)
+			end;
+		begin
+			i := 0;
+			repeat
+				show(i);
+				i := i + 1
+			until i = k
+		end;
+	begin
+		n := 5;
+		r := 1;
+		swap(n, r);
+		writeln(n, r);
+		writeln(factorial(r));
+		count(3)
+	end.
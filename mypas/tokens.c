@@ -0,0 +1,71 @@
+// tokens.c
+#include <stdio.h>
+#include <stdlib.h>
+#include "tokens.h"
+
+_Thread_local TOKENS tokens;
+
+/**
+ * Aumenta os vetores de tokens para comportar `capacity` tokens.
+ */
+static void tokens_grow(TOKENS *toks, int capacity)
+{
+    short *kinds = realloc(toks->kinds, capacity * sizeof(*kinds));
+    int *offsets = realloc(toks->offsets, capacity * sizeof(*offsets));
+    int *lines = realloc(toks->lines, capacity * sizeof(*lines));
+    int *ids = realloc(toks->ids, capacity * sizeof(*ids));
+    if (!kinds || !offsets || !lines || !ids)
+    {
+        fprintf(stderr, "Erro: memória insuficiente para os tokens.\n");
+        exit(EXIT_FAILURE);
+    }
+    toks->kinds = kinds;
+    toks->offsets = offsets;
+    toks->lines = lines;
+    toks->ids = ids;
+    toks->capacity = capacity;
+}
+
+/**
+ * Analisa toda a entrada de `lex`, acrescentando os tokens a `toks` até o fim
+ * de arquivo, inclusive. Retorna o número de tokens.
+ * A capacidade inicial é estimada pelo tamanho da entrada (um token a cada
+ * quatro bytes), de modo que arquivos típicos não precisam de realocação.
+ */
+int tokenize(TOKENS *toks, LEXER *lex)
+{
+    int estimate = (lex->limit - lex->cur) / 4 + 16;
+    if (toks->capacity < estimate)
+        tokens_grow(toks, estimate);
+
+    toks->count = 0;
+    int token;
+    do
+    {
+        if (toks->count == toks->capacity)
+            tokens_grow(toks, 2 * toks->capacity);
+
+        token = lexer_next(lex);
+        int i = toks->count++;
+        toks->kinds[i] = token;
+        toks->offsets[i] = lex->offset;
+        toks->lines[i] = lex->line;
+        toks->ids[i] = token == ID ? lex->id : -1;
+    } while (token != -1);
+
+    return toks->count;
+}
+
+/**
+ * Libera os vetores de tokens.
+ */
+void tokens_free(TOKENS *toks)
+{
+    free(toks->kinds);
+    free(toks->offsets);
+    free(toks->lines);
+    free(toks->ids);
+    toks->kinds = NULL;
+    toks->offsets = toks->lines = toks->ids = NULL;
+    toks->count = toks->capacity = 0;
+}
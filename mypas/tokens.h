@@ -0,0 +1,26 @@
+// tokens.h
+#ifndef TOKENS_H
+#define TOKENS_H
+
+#include "lexer.h"
+
+// Tokens de um arquivo inteiro, produzidos antes da análise sintática e
+// guardados como estrutura de vetores: cada atributo fica num vetor contíguo,
+// indexado pela posição do token. O último token é sempre o fim de arquivo (-1).
+typedef struct
+{
+    short *kinds;  // Tipo de cada token (caractere, ID, DEC, palavra-chave ou -1)
+    int *offsets;  // Posição do token na entrada
+    int *lines;    // Linha do token
+    int *ids;      // Id do identificador (apenas para ID)
+    int count;     // Número de tokens, inclusive o fim de arquivo
+    int capacity;  // Capacidade dos vetores
+} TOKENS;
+
+// Tokens do programa em compilação na thread corrente
+extern _Thread_local TOKENS tokens;
+
+int tokenize(TOKENS *toks, LEXER *lex);
+void tokens_free(TOKENS *toks);
+
+#endif